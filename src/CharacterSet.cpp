@@ -17,7 +17,12 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#ifdef __x86_64__
+#include <emmintrin.h>
+#endif
+
 #include "CharacterSet.h"
+#include "RuntimeException.h"
 
 using namespace std;
 
@@ -30,6 +35,95 @@ namespace OpenLogReplicator {
     CharacterSet::~CharacterSet() {
     }
 
+    //converts to UTF-8, output must have space for 4 bytes per input byte
+    uint64_t CharacterSet::transcode(const uint8_t *str, uint64_t length, uint8_t *output) {
+        uint8_t *pos = output;
+        while (length > 0)
+            pos = encodeUTF8(decode(str, length), pos);
+        return pos - output;
+    }
+
+    uint8_t *CharacterSet::encodeUTF8(typeunicode character, uint8_t *output) {
+        //0xxxxxxx
+        if (character <= 0x7F) {
+            *output++ = character;
+
+        //110xxxxx 10xxxxxx
+        } else if (character <= 0x7FF) {
+            *output++ = 0xC0 | (uint8_t)(character >> 6);
+            *output++ = 0x80 | (uint8_t)(character & 0x3F);
+
+        //1110xxxx 10xxxxxx 10xxxxxx
+        } else if (character <= 0xFFFF) {
+            *output++ = 0xE0 | (uint8_t)(character >> 12);
+            *output++ = 0x80 | (uint8_t)((character >> 6) & 0x3F);
+            *output++ = 0x80 | (uint8_t)(character & 0x3F);
+
+        //11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+        } else if (character <= 0x10FFFF) {
+            *output++ = 0xF0 | (uint8_t)(character >> 18);
+            *output++ = 0x80 | (uint8_t)((character >> 12) & 0x3F);
+            *output++ = 0x80 | (uint8_t)((character >> 6) & 0x3F);
+            *output++ = 0x80 | (uint8_t)(character & 0x3F);
+
+        } else {
+            RUNTIME_FAIL("got character code: U+" << dec << character);
+        }
+        return output;
+    }
+
+    //length of prefix with 7-bit characters only
+    uint64_t CharacterSet::asciiRun(const uint8_t *str, uint64_t length) {
+        uint64_t i = 0;
+#ifdef __x86_64__
+        for (; i + 16 <= length; i += 16) {
+            uint32_t bits = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(str + i)));
+            if (bits != 0)
+                return i + __builtin_ctz(bits);
+        }
+#endif
+        while (i < length && str[i] < 0x80)
+            ++i;
+        return i;
+    }
+
+    //length of prefix which is already in shortest form UTF-8 and decodes to the same bytes
+    uint64_t CharacterSet::utf8Run(const uint8_t *str, uint64_t length, bool fourBytes) {
+        uint64_t i = 0;
+        while (i < length) {
+            i += asciiRun(str + i, length - i);
+            if (i == length)
+                break;
+
+            uint8_t byte1 = str[i];
+            //110xxxxx 10xxxxxx
+            if (byte1 >= 0xC2 && byte1 <= 0xDF) {
+                if (i + 1 >= length || (str[i + 1] & 0xC0) != 0x80)
+                    break;
+                i += 2;
+
+            //1110xxxx 10xxxxxx 10xxxxxx, without surrogates
+            } else if (byte1 >= 0xE0 && byte1 <= 0xEF) {
+                if (i + 2 >= length || (str[i + 1] & 0xC0) != 0x80 || (str[i + 2] & 0xC0) != 0x80)
+                    break;
+                if ((byte1 == 0xE0 && str[i + 1] < 0xA0) || (byte1 == 0xED && str[i + 1] >= 0xA0))
+                    break;
+                i += 3;
+
+            //11110xxx 10xxxxxx 10xxxxxx 10xxxxxx, up to U+10FFFF
+            } else if (fourBytes && byte1 >= 0xF0 && byte1 <= 0xF4) {
+                if (i + 3 >= length || (str[i + 1] & 0xC0) != 0x80 || (str[i + 2] & 0xC0) != 0x80 || (str[i + 3] & 0xC0) != 0x80)
+                    break;
+                if ((byte1 == 0xF0 && str[i + 1] < 0x90) || (byte1 == 0xF4 && str[i + 1] >= 0x90))
+                    break;
+                i += 4;
+
+            } else
+                break;
+        }
+        return i;
+    }
+
     uint64_t CharacterSet::badChar(uint64_t byte1) {
         ERROR("can't decode character: 0x" << setfill('0') << setw(2) << hex << byte1 << " in character set " << name);
         return UNICODE_UNKNOWN_CHARACTER;
@@ -36,6 +36,8 @@ namespace OpenLogReplicator {
         uint64_t badChar(uint64_t byte1, uint64_t byte2, uint64_t byte3, uint64_t byte4);
         uint64_t badChar(uint64_t byte1, uint64_t byte2, uint64_t byte3, uint64_t byte4, uint64_t byte5);
         uint64_t badChar(uint64_t byte1, uint64_t byte2, uint64_t byte3, uint64_t byte4, uint64_t byte5, uint64_t byte6);
+        static uint64_t asciiRun(const uint8_t *str, uint64_t length);
+        static uint64_t utf8Run(const uint8_t *str, uint64_t length, bool fourBytes);
 
     public:
         const char *name;
@@ -44,6 +46,8 @@ namespace OpenLogReplicator {
         virtual ~CharacterSet();
 
         virtual uint64_t decode(const uint8_t* &str, uint64_t &length) = 0;
+        virtual uint64_t transcode(const uint8_t *str, uint64_t length, uint8_t *output);
+        static uint8_t *encodeUTF8(typeunicode character, uint8_t *output);
     };
 }
 
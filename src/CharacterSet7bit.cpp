@@ -41,6 +41,13 @@ namespace OpenLogReplicator {
         return map[character];
     }
 
+    uint64_t CharacterSet7bit::transcode(const uint8_t *str, uint64_t length, uint8_t *output) {
+        uint8_t *pos = output;
+        for (uint64_t i = 0; i < length; ++i)
+            pos = encodeUTF8(map[str[i] & 0x7F], pos);
+        return pos - output;
+    }
+
     //conversion arrays for 7-bit character sets
     typeunicode16 CharacterSet7bit::unicode_map_D7DEC[128] = {
         0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007, 0x0008, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, 0x000F, 0x0010, 0x0011, 0x0012, 0x0013, 0x0014, 0x0015, 0x0016, 0x0017, 0x0018, 0x0019, 0x001A, 0x001B, 0x001C, 0x001D, 0x001E, 0x001F, 0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F, 0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
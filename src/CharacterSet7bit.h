@@ -36,6 +36,7 @@ namespace OpenLogReplicator {
         virtual ~CharacterSet7bit();
 
         virtual typeunicode decode(const uint8_t* &str, uint64_t &length);
+        virtual uint64_t transcode(const uint8_t *str, uint64_t length, uint8_t *output);
 
         //conversion arrays for 7-bit character sets
         static typeunicode16 unicode_map_D7DEC[128];
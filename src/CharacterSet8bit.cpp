@@ -42,6 +42,31 @@ namespace OpenLogReplicator {
         return readMap(byte1);
     }
 
+    uint64_t CharacterSet8bit::transcode(const uint8_t *str, uint64_t length, uint8_t *output) {
+        uint8_t *pos = output;
+        if (customASCII) {
+            for (uint64_t i = 0; i < length; ++i)
+                pos = encodeUTF8(map[str[i]], pos);
+            return pos - output;
+        }
+
+        while (length > 0) {
+            //7-bit characters are copied as they are
+            uint64_t run = asciiRun(str, length);
+            memcpy(pos, str, run);
+            pos += run;
+            str += run;
+            length -= run;
+
+            while (length > 0 && *str >= 0x80) {
+                pos = encodeUTF8(map[*str - 128], pos);
+                ++str;
+                --length;
+            }
+        }
+        return pos - output;
+    }
+
     typeunicode CharacterSet8bit::readMap(uint64_t character) {
         if (customASCII)
             return map[character];
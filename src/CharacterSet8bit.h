@@ -37,6 +37,7 @@ namespace OpenLogReplicator {
         virtual ~CharacterSet8bit();
 
         virtual typeunicode decode(const uint8_t* &str, uint64_t &length);
+        virtual uint64_t transcode(const uint8_t *str, uint64_t length, uint8_t *output);
 
         static typeunicode16 unicode_map_AR8ADOS710[128];
         static typeunicode16 unicode_map_AR8ADOS710T[128];
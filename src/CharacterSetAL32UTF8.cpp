@@ -82,4 +82,20 @@ namespace OpenLogReplicator {
 
         return badChar(byte1, byte2, byte3, byte4);
     }
+
+    uint64_t CharacterSetAL32UTF8::transcode(const uint8_t *str, uint64_t length, uint8_t *output) {
+        uint8_t *pos = output;
+        while (length > 0) {
+            //valid characters are copied as they are
+            uint64_t run = utf8Run(str, length, true);
+            memcpy(pos, str, run);
+            pos += run;
+            str += run;
+            length -= run;
+
+            if (length > 0)
+                pos = encodeUTF8(decode(str, length), pos);
+        }
+        return pos - output;
+    }
 }
@@ -94,4 +94,20 @@ namespace OpenLogReplicator {
 
         return ((byte1 & 0x0F) << 12) | ((byte2 & 0x3F) << 6) | (byte3 & 0x3F);
     }
+
+    uint64_t CharacterSetUTF8::transcode(const uint8_t *str, uint64_t length, uint8_t *output) {
+        uint8_t *pos = output;
+        while (length > 0) {
+            //valid characters are copied as they are
+            uint64_t run = utf8Run(str, length, false);
+            memcpy(pos, str, run);
+            pos += run;
+            str += run;
+            length -= run;
+
+            if (length > 0)
+                pos = encodeUTF8(decode(str, length), pos);
+        }
+        return pos - output;
+    }
 }
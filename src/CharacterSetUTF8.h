@@ -32,6 +32,7 @@ namespace OpenLogReplicator {
         virtual ~CharacterSetUTF8();
 
         virtual typeunicode decode(const uint8_t* &str, uint64_t &length);
+        virtual uint64_t transcode(const uint8_t *str, uint64_t length, uint8_t *output);
     };
 }
 
@@ -121,10 +121,12 @@ namespace OpenLogReplicator {
             return;
         }
 
-        if (redoLogRecord->opc == 0x0A16)
-            oracleAnalyzer->dumpStream << "index undo for leaf key operations" << endl;
-        else if (redoLogRecord->opc == 0x0B01)
-            oracleAnalyzer->dumpStream << "KDO undo record:" << endl;
+        if (oracleAnalyzer->dumpRedoLog >= 1) {
+            if (redoLogRecord->opc == 0x0A16)
+                oracleAnalyzer->dumpStream << "index undo for leaf key operations" << endl;
+            else if (redoLogRecord->opc == 0x0B01)
+                oracleAnalyzer->dumpStream << "KDO undo record:" << endl;
+        }
 
         int8_t op = redoLogRecord->data[fieldPos + 0];
         uint8_t flg = redoLogRecord->data[fieldPos + 1];
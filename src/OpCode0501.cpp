@@ -284,9 +284,11 @@ namespace OpenLogReplicator {
         if (fieldLength >= 26) {
             redoLogRecord->suppLogBdba = oracleAnalyzer->read32(redoLogRecord->data + fieldPos + 20);
             redoLogRecord->suppLogSlot = oracleAnalyzer->read16(redoLogRecord->data + fieldPos + 24);
-            oracleAnalyzer->dumpStream <<
-                    "supp log bdba: 0x" << setfill('0') << setw(8) << hex << redoLogRecord->suppLogBdba <<
-                    "." << hex << redoLogRecord->suppLogSlot << endl;
+            if (oracleAnalyzer->dumpRedoLog >= 1) {
+                oracleAnalyzer->dumpStream <<
+                        "supp log bdba: 0x" << setfill('0') << setw(8) << hex << redoLogRecord->suppLogBdba <<
+                        "." << hex << redoLogRecord->suppLogSlot << endl;
+            }
         } else {
             redoLogRecord->suppLogBdba = redoLogRecord->bdba;
             redoLogRecord->suppLogSlot = redoLogRecord->slot;
@@ -32,10 +32,15 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "OracleAnalyzer.h"
 #include "OracleAnalyzerBatch.h"
 #include "OutputBuffer.h"
+#include "OutputBufferArrow.h"
+#include "OutputBufferAvro.h"
 #include "OutputBufferJson.h"
+#include "RedoLogDecoder.h"
 #include "RuntimeException.h"
 #include "Schema.h"
 #include "SchemaElement.h"
+#include "TransactionFormatter.h"
+#include "TransactionStats.h"
 #include "Writer.h"
 #include "WriterFile.h"
 
@@ -249,6 +254,37 @@ int main(int argc, char **argv) {
                 disableChecks = disableChecksJSON.GetUint64();
             }
 
+            //optional
+            uint64_t decoderThreads = 0;
+            if (readerJSON.HasMember("decoder-threads")) {
+                const Value& decoderThreadsJSON = readerJSON["decoder-threads"];
+                decoderThreads = decoderThreadsJSON.GetUint64();
+                if (decoderThreads > MAX_DECODER_THREADS) {
+                    CONFIG_FAIL("bad JSON, \"decoder-threads\" value must be at most " << dec << MAX_DECODER_THREADS);
+                }
+            }
+
+            //optional
+            uint64_t transactionStatsInterval = 0;
+            if (readerJSON.HasMember("transaction-stats-interval")) {
+                const Value& transactionStatsIntervalJSON = readerJSON["transaction-stats-interval"];
+                transactionStatsInterval = transactionStatsIntervalJSON.GetUint64();
+            }
+
+            //optional
+            uint64_t transactionStatsTop = 10;
+            if (readerJSON.HasMember("transaction-stats-top")) {
+                const Value& transactionStatsTopJSON = readerJSON["transaction-stats-top"];
+                transactionStatsTop = transactionStatsTopJSON.GetUint64();
+            }
+
+            //optional
+            uint64_t snapshotInterval = 0;
+            if (readerJSON.HasMember("snapshot-interval")) {
+                const Value& snapshotIntervalJSON = readerJSON["snapshot-interval"];
+                snapshotInterval = snapshotIntervalJSON.GetUint64();
+            }
+
             const Value& nameJSON = getJSONfieldV(configFileName, sourceJSON, "name");
 
             //format
@@ -334,13 +370,71 @@ int main(int argc, char **argv) {
                 }
             }
 
+            //optional
+            uint64_t streamTransactionOps = 0;
+            if (formatJSON.HasMember("stream-transaction-ops")) {
+                const Value& streamTransactionOpsJSON = formatJSON["stream-transaction-ops"];
+                streamTransactionOps = streamTransactionOpsJSON.GetUint64();
+            }
+
+            //optional
+            uint64_t formatterThreads = 0;
+            if (formatJSON.HasMember("formatter-threads")) {
+                const Value& formatterThreadsJSON = formatJSON["formatter-threads"];
+                formatterThreads = formatterThreadsJSON.GetUint64();
+                if (formatterThreads > MAX_FORMATTER_THREADS) {
+                    CONFIG_FAIL("bad JSON, \"formatter-threads\" value must be at most " << dec << MAX_FORMATTER_THREADS);
+                }
+            }
+
             const Value& formatTypeJSON = getJSONfieldV(configFileName, formatJSON, "type");
 
             OutputBuffer *outputBuffer = nullptr;
             if (strcmp("json", formatTypeJSON.GetString()) == 0) {
                 outputBuffer = new OutputBufferJson(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat);
+            } else if (strcmp("arrow", formatTypeJSON.GetString()) == 0) {
+                if (streamTransactionOps > 0) {
+                    CONFIG_FAIL("bad JSON, \"stream-transaction-ops\" is not supported for \"arrow\" format");
+                }
+                if (formatterThreads > 0) {
+                    CONFIG_FAIL("bad JSON, \"formatter-threads\" is not supported for \"arrow\" format");
+                }
+
+                //optional
+                uint64_t batchRows = 10000;
+                if (formatJSON.HasMember("batch-rows")) {
+                    const Value& batchRowsJSON = formatJSON["batch-rows"];
+                    batchRows = batchRowsJSON.GetUint64();
+                    if (batchRows == 0) {
+                        CONFIG_FAIL("bad JSON, \"batch-rows\" value must be greater than 0");
+                    }
+                }
+
+                //optional
+                uint64_t batchLatencyMs = 1000;
+                if (formatJSON.HasMember("batch-latency-ms")) {
+                    const Value& batchLatencyMsJSON = formatJSON["batch-latency-ms"];
+                    batchLatencyMs = batchLatencyMsJSON.GetUint64();
+                }
+                outputBuffer = new OutputBufferArrow(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat,
+                        batchRows, batchLatencyMs);
+            } else if (strcmp("avro", formatTypeJSON.GetString()) == 0) {
+                if (streamTransactionOps > 0) {
+                    CONFIG_FAIL("bad JSON, \"stream-transaction-ops\" is not supported for \"avro\" format");
+                }
+
+                //optional
+                const char *schemaPath = ".";
+                if (formatJSON.HasMember("schema-path")) {
+                    const Value& schemaPathJSON = formatJSON["schema-path"];
+                    schemaPath = schemaPathJSON.GetString();
+                }
+                outputBuffer = new OutputBufferAvro(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat, schemaPath);
             } else if (strcmp("protobuf", formatTypeJSON.GetString()) == 0) {
 #ifdef LINK_LIBRARY_PROTOBUF
+                if (streamTransactionOps > 0) {
+                    CONFIG_FAIL("bad JSON, \"stream-transaction-ops\" is not supported for \"protobuf\" format");
+                }
                 outputBuffer = new OutputBufferProtobuf(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat);
 #else
                 RUNTIME_FAIL("format \"protobuf\" is not compiled, exiting");
@@ -538,6 +632,12 @@ int main(int argc, char **argv) {
                 CONFIG_FAIL("bad JSON, invalid \"format\" value: " << readerTypeJSON.GetString());
             }
 
+            oracleAnalyzer->decoderThreads = decoderThreads;
+            oracleAnalyzer->streamTransactionOps = streamTransactionOps;
+            oracleAnalyzer->snapshotInterval = snapshotInterval;
+            oracleAnalyzer->formatterThreads = formatterThreads;
+            oracleAnalyzer->transactionStats->interval = transactionStatsInterval;
+            oracleAnalyzer->transactionStats->top = transactionStatsTop;
             outputBuffer->initialize(oracleAnalyzer);
 
             if (sourceJSON.HasMember("event-table")) {
@@ -547,6 +647,28 @@ int main(int argc, char **argv) {
                 element->options = 1;
             }
 
+            if (sourceJSON.HasMember("skip-session")) {
+                const Value& skipSessionJSON = sourceJSON["skip-session"];
+                const char *skipSessionNames[] = {"user", "program", "transaction-name", "client-info", "client-id"};
+                set<string> *skipSessionSets[] = {&oracleAnalyzer->skipSessionUser, &oracleAnalyzer->skipSessionProgram,
+                        &oracleAnalyzer->skipSessionTransactionName, &oracleAnalyzer->skipSessionClientInfo, &oracleAnalyzer->skipSessionClientId};
+
+                for (uint64_t j = 0; j < 5; ++j) {
+                    if (!skipSessionJSON.HasMember(skipSessionNames[j]))
+                        continue;
+
+                    const Value& valuesJSON = skipSessionJSON[skipSessionNames[j]];
+                    if (!valuesJSON.IsArray()) {
+                        CONFIG_FAIL("bad JSON, field \"" << skipSessionNames[j] << "\" of \"skip-session\" should be array");
+                    }
+
+                    for (SizeType k = 0; k < valuesJSON.Size(); ++k) {
+                        skipSessionSets[j]->insert(valuesJSON[k].GetString());
+                        oracleAnalyzer->skipSession = true;
+                    }
+                }
+            }
+
             const Value& tablesJSON = getJSONfieldV(configFileName, sourceJSON, "tables");
             if (!tablesJSON.IsArray()) {
                 CONFIG_FAIL("bad JSON, field \"tables\" should be array");
@@ -721,15 +843,56 @@ int main(int argc, char **argv) {
                     }
                 }
 
+                //optional, passed to producer configuration
+                map<string, string> properties;
+                if (writerJSON.HasMember("properties")) {
+                    const Value& propertiesJSON = writerJSON["properties"];
+                    if (!propertiesJSON.IsObject()) {
+                        CONFIG_FAIL("bad JSON, \"properties\" should be object");
+                    }
+                    for (Value::ConstMemberIterator it = propertiesJSON.MemberBegin(); it != propertiesJSON.MemberEnd(); ++it) {
+                        if (it->value.IsString())
+                            properties[it->name.GetString()] = it->value.GetString();
+                        else if (it->value.IsUint64())
+                            properties[it->name.GetString()] = to_string(it->value.GetUint64());
+                        else if (it->value.IsBool())
+                            properties[it->name.GetString()] = it->value.GetBool() ? "true" : "false";
+                        else {
+                            CONFIG_FAIL("bad JSON, invalid \"properties\" value for: " << it->name.GetString() << ", expected string or number");
+                        }
+                    }
+                }
+
+                //optional, seconds between throughput reports
+                uint64_t benchmark = 0;
+                if (writerJSON.HasMember("benchmark")) {
+                    const Value& benchmarkJSON = writerJSON["benchmark"];
+                    benchmark = benchmarkJSON.GetUint64();
+                }
+
                 const Value& brokersJSON = getJSONfieldV(configFileName, writerJSON, "brokers");
                 const Value& topicJSON = getJSONfieldV(configFileName, writerJSON, "topic");
 
-                writer = new WriterKafka(aliasJSON.GetString(), oracleAnalyzer, brokersJSON.GetString(),
+                WriterKafka *writerKafka = new WriterKafka(aliasJSON.GetString(), oracleAnalyzer, brokersJSON.GetString(),
                         topicJSON.GetString(), maxMessageMb, maxMessages, pollInterval, checkpointInterval, queueSize,
-                        startScn, startSequence, startTime, startTimeRel, enableIdempocence);
-                if (writer == nullptr) {
+                        startScn, startSequence, startTime, startTimeRel, enableIdempocence, properties, benchmark);
+                if (writerKafka == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(WriterKafka) << " bytes memory (for: Kafka writer)");
                 }
+                writer = writerKafka;
+
+                //optional, per-table topics
+                if (writerJSON.HasMember("topics")) {
+                    const Value& topicsJSON = writerJSON["topics"];
+                    if (!topicsJSON.IsArray()) {
+                        CONFIG_FAIL("bad JSON, \"topics\" should be array");
+                    }
+                    for (SizeType k = 0; k < topicsJSON.Size(); ++k) {
+                        const Value& tableJSON = getJSONfieldV(configFileName, topicsJSON[k], "table");
+                        const Value& tableTopicJSON = getJSONfieldV(configFileName, topicsJSON[k], "topic");
+                        writerKafka->addTopic(tableJSON.GetString(), tableTopicJSON.GetString());
+                    }
+                }
 #else
                 RUNTIME_FAIL("Writer Kafka is not compiled, exiting")
 #endif /* LINK_LIBRARY_RDKAFKA */
@@ -825,6 +988,11 @@ int main(int argc, char **argv) {
         delete outputBuffer;
     buffers.clear();
 
+#ifdef LINK_LIBRARY_PROTOBUF
+    //library is shared by all protobuf output buffers and formatters
+    google::protobuf::ShutdownProtobufLibrary();
+#endif /* LINK_LIBRARY_PROTOBUF */
+
     for (OracleAnalyzer *analyzer : analyzers)
         delete analyzer;
     analyzers.clear();
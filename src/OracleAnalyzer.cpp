@@ -23,15 +23,20 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include <sys/stat.h>
 
 #include "ConfigurationException.h"
+#include "OpCode.h"
 #include "OracleAnalyzer.h"
 #include "OutputBuffer.h"
 #include "ReaderFilesystem.h"
 #include "RedoLog.h"
+#include "RedoLogDecoder.h"
 #include "RedoLogException.h"
 #include "RuntimeException.h"
 #include "Schema.h"
 #include "Transaction.h"
 #include "TransactionBuffer.h"
+#include "TransactionFormatter.h"
+#include "TransactionSnapshot.h"
+#include "TransactionStats.h"
 
 using namespace std;
 
@@ -65,12 +70,14 @@ namespace OpenLogReplicator {
         startSequence(0),
         startTimeRel(0),
         transactionBuffer(nullptr),
+        transactionStats(nullptr),
         schema(nullptr),
         outputBuffer(outputBuffer),
         dumpRedoLog(dumpRedoLog),
         dumpRawData(dumpRawData),
         flags(flags),
         disableChecks(disableChecks),
+        skipSession(false),
         redoReadSleep(redoReadSleep),
         archReadSleep(archReadSleep),
         trace(trace),
@@ -83,6 +90,17 @@ namespace OpenLogReplicator {
         suppLogSize(0),
         version12(false),
         archGetLog(archGetLogPath),
+        decoderThreads(0),
+        streamTransactionOps(0),
+        snapshotInterval(0),
+        transactionSnapshot(nullptr),
+        decoderOpCodes(nullptr),
+        decoderOpCodesNum(0),
+        decoderBatch(0),
+        decoderRunning(0),
+        decoderFailedVector(0),
+        formatterThreads(0),
+        formatterFailed(false),
         read16(read16Little),
         read32(read32Little),
         read56(read56Little),
@@ -116,6 +134,11 @@ namespace OpenLogReplicator {
             RUNTIME_FAIL("couldn't allocate " << dec << sizeof(TransactionBuffer) << " bytes memory (for: memory chunks#5)");
         }
 
+        transactionStats = new TransactionStats(this);
+        if (transactionStats == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(TransactionStats) << " bytes memory (for: transaction stats)");
+        }
+
         schema = new Schema();
         if (schema == nullptr) {
             RUNTIME_FAIL("couldn't allocate " << dec << sizeof(Schema) << " bytes memory (for: schema)");
@@ -124,6 +147,7 @@ namespace OpenLogReplicator {
 
     OracleAnalyzer::~OracleAnalyzer() {
         readerDropAll();
+        decoderDropAll();
 
         while (!archiveRedoQueue.empty()) {
             RedoLog *redoTmp = archiveRedoQueue.top();
@@ -135,11 +159,17 @@ namespace OpenLogReplicator {
             delete redoLog;
         onlineRedoSet.clear();
 
-        for (auto it : xidTransactionMap) {
-            Transaction *transaction = it.second;
+        vector<Transaction*> transactions;
+        xidTransactionMap.list(transactions);
+        for (Transaction *transaction : transactions) {
+            xidTransactionMap.erase(transaction->xid >> 32);
             delete transaction;
         }
-        xidTransactionMap.clear();
+
+        if (transactionStats != nullptr) {
+            delete transactionStats;
+            transactionStats = nullptr;
+        }
 
         if (transactionBuffer != nullptr) {
             delete transactionBuffer;
@@ -161,6 +191,14 @@ namespace OpenLogReplicator {
             delete schema;
             schema = nullptr;
         }
+
+        if (transactionSnapshot != nullptr) {
+            transactionSnapshot->doShutdown();
+            if (transactionSnapshot->started)
+                pthread_join(transactionSnapshot->pthread, nullptr);
+            delete transactionSnapshot;
+            transactionSnapshot = nullptr;
+        }
     }
 
     void OracleAnalyzer::updateOnlineLogs(void) {
@@ -437,6 +475,17 @@ namespace OpenLogReplicator {
 
         try {
             initialize();
+            decoderCreate();
+            formatterCreate();
+            if (snapshotInterval > 0) {
+                transactionSnapshot = new TransactionSnapshot(alias.c_str(), this, snapshotInterval);
+                if (transactionSnapshot == nullptr) {
+                    RUNTIME_FAIL("couldn't allocate " << dec << sizeof(TransactionSnapshot) << " bytes memory (for: transaction snapshot)");
+                }
+                if (pthread_create(&transactionSnapshot->pthread, nullptr, &TransactionSnapshot::runStatic, (void*)transactionSnapshot)) {
+                    CONFIG_FAIL("spawning thread");
+                }
+            }
             while (scn == ZERO_SCN) {
                 {
                     unique_lock<mutex> lck(mtx);
@@ -470,6 +519,12 @@ namespace OpenLogReplicator {
                     return 0;
 
                 start();
+
+                //open transactions from snapshot, redo is read again from snapshot position
+                if (transactionSnapshot != nullptr && startSequence == 0 && startTime.length() == 0 && startTimeRel == 0 &&
+                        scn != ZERO_SCN && transactionSnapshot->read(scn))
+                    sequence = transactionSnapshot->sequence;
+
                 {
                     unique_lock<mutex> lck(mtx);
                     outputBuffer->writersCond.notify_all();
@@ -624,11 +679,14 @@ namespace OpenLogReplicator {
                 if (shutdown)
                     break;
 
+                formatterDrain();
                 if (!continueWithOnline())
                     break;
 
-                if (!logsProcessed)
+                if (!logsProcessed) {
+                    outputBuffer->processPoll();
                     usleep(redoReadSleep);
+                }
             }
         } catch(ConfigurationException &ex) {
             stopMain();
@@ -640,9 +698,12 @@ namespace OpenLogReplicator {
 
         FULL_(*this);
         readerDropAll();
+        decoderDropAll();
+        formatterDropAll();
 
         INFO_("Oracle analyzer for: " << database << " is shut down, allocated at most " << dec <<
-                (memoryChunksHWM * MEMORY_CHUNK_SIZE_MB) << "MB memory");
+                (memoryChunksHWM * MEMORY_CHUNK_SIZE_MB) << "MB memory, LWN chunks held by open transactions at most " <<
+                (transactionBuffer->lwnChunksPinnedHWM * MEMORY_CHUNK_SIZE_MB) << "MB");
 
         TRACE_(TRACE2_THREADS, "ANALYZER (" << hex << this_thread::get_id() << ") STOP");
         return 0;
@@ -699,6 +760,187 @@ namespace OpenLogReplicator {
         return readerFS;
     }
 
+    void OracleAnalyzer::decoderCreate(void) {
+        //vectors are decoded sequentially when dumping, so that the dump keeps redo order
+        if (dumpRedoLog >= 1 || dumpRawData > 0)
+            return;
+
+        for (uint64_t i = 0; i < decoderThreads; ++i) {
+            RedoLogDecoder *decoder = new RedoLogDecoder(alias.c_str(), this, i);
+            if (decoder == nullptr) {
+                RUNTIME_FAIL("couldn't allocate " << dec << sizeof(RedoLogDecoder) << " bytes memory (for: decoder creation)");
+            }
+
+            decoders.push_back(decoder);
+            if (pthread_create(&decoder->pthread, nullptr, &RedoLogDecoder::runStatic, (void*)decoder)) {
+                CONFIG_FAIL("spawning thread");
+            }
+        }
+    }
+
+    void OracleAnalyzer::decoderDropAll(void) {
+        {
+            unique_lock<mutex> lck(decoderMtx);
+            for (RedoLogDecoder *decoder : decoders)
+                decoder->shutdown = true;
+            decoderCond.notify_all();
+        }
+        for (RedoLogDecoder *decoder : decoders) {
+            if (decoder->started)
+                pthread_join(decoder->pthread, nullptr);
+            delete decoder;
+        }
+        decoders.clear();
+    }
+
+    //returns number of vectors before the first one which failed to decode, opCodesNum when all are decoded
+    uint64_t OracleAnalyzer::decoderProcess(OpCode **opCodes, uint64_t opCodesNum) {
+        if (opCodesNum == 0)
+            return 0;
+
+        if (decoders.size() == 0) {
+            for (uint64_t i = 0; i < opCodesNum; ++i) {
+                try {
+                    opCodes[i]->process();
+                } catch(RedoLogException &ex) {
+                    return i;
+                }
+            }
+            return opCodesNum;
+        }
+
+        {
+            unique_lock<mutex> lck(decoderMtx);
+            decoderOpCodes = opCodes;
+            decoderOpCodesNum = opCodesNum;
+            decoderRunning = decoders.size();
+            decoderFailedVector = opCodesNum;
+            ++decoderBatch;
+            decoderCond.notify_all();
+        }
+
+        uint64_t decoded = RedoLogDecoder::processSlice(this, decoders.size());
+
+        {
+            unique_lock<mutex> lck(decoderMtx);
+            while (decoderRunning > 0)
+                decoderDoneCond.wait(lck);
+            if (decoderFailedVector < decoded)
+                decoded = decoderFailedVector;
+            decoderOpCodes = nullptr;
+            decoderOpCodesNum = 0;
+        }
+
+        return decoded;
+    }
+
+    void OracleAnalyzer::formatterCreate(void) {
+        for (uint64_t i = 0; i < formatterThreads; ++i) {
+            OutputBuffer *formatterBuffer = outputBuffer->newFormatter();
+            formatterBuffer->initialize(this);
+            formatterBuffer->defaultCharacterMapId = outputBuffer->defaultCharacterMapId;
+            formatterBuffer->defaultCharacterNcharMapId = outputBuffer->defaultCharacterNcharMapId;
+
+            TransactionFormatter *formatter = new TransactionFormatter(alias.c_str(), this, i, formatterBuffer);
+            if (formatter == nullptr) {
+                delete formatterBuffer;
+                RUNTIME_FAIL("couldn't allocate " << dec << sizeof(TransactionFormatter) << " bytes memory (for: formatter creation)");
+            }
+
+            formatters.push_back(formatter);
+            if (pthread_create(&formatter->pthread, nullptr, &TransactionFormatter::runStatic, (void*)formatter)) {
+                CONFIG_FAIL("spawning thread");
+            }
+        }
+    }
+
+    void OracleAnalyzer::formatterDropAll(void) {
+        {
+            unique_lock<mutex> lck(formatterMtx);
+            for (TransactionFormatter *formatter : formatters)
+                formatter->shutdown = true;
+            formatterCond.notify_all();
+        }
+        for (TransactionFormatter *formatter : formatters) {
+            if (formatter->started)
+                pthread_join(formatter->pthread, nullptr);
+            if (formatter->transaction != nullptr)
+                formattedTransactions.push_back(formatter->transaction);
+            delete formatter;
+        }
+        formatters.clear();
+        formattersQueue.clear();
+        formatterRelease();
+    }
+
+    bool OracleAnalyzer::formatterSubmit(Transaction *transaction) {
+        if (formatters.size() == 0)
+            return false;
+
+        //provisional output and rollback markers are written directly, after all transactions committed earlier
+        if (transaction->streamedOps > 0) {
+            formatterDrain();
+            return false;
+        }
+        if (transaction->opCodes == 0 || transaction->isRollback)
+            return false;
+
+        {
+            unique_lock<mutex> lck(formatterMtx);
+            TransactionFormatter *idle = nullptr;
+            while (idle == nullptr && !formatterFailed) {
+                for (TransactionFormatter *formatter : formatters) {
+                    if (formatter->transaction == nullptr) {
+                        idle = formatter;
+                        break;
+                    }
+                }
+                if (idle == nullptr)
+                    formatterCond.wait(lck);
+            }
+
+            if (formatterFailed) {
+                RUNTIME_FAIL("formatting of transaction failed");
+            }
+
+            TRACE_(TRACE2_TRANSACTION, "formatting transaction " << PRINTXID(transaction->xid));
+            idle->transaction = transaction;
+            formattersQueue.push_back(idle);
+            formatterCond.notify_all();
+        }
+
+        formatterRelease();
+        return true;
+    }
+
+    void OracleAnalyzer::formatterDrain(void) {
+        if (formatters.size() == 0)
+            return;
+
+        {
+            unique_lock<mutex> lck(formatterMtx);
+            while (!formattersQueue.empty() && !formatterFailed)
+                formatterCond.wait(lck);
+
+            if (formatterFailed) {
+                RUNTIME_FAIL("formatting of transaction failed");
+            }
+        }
+
+        formatterRelease();
+    }
+
+    void OracleAnalyzer::formatterRelease(void) {
+        vector<Transaction*> transactions;
+        {
+            unique_lock<mutex> lck(formatterMtx);
+            transactions.swap(formattedTransactions);
+        }
+
+        for (Transaction *transaction : transactions)
+            transactionBuffer->deleteTransaction(transaction);
+    }
+
     void OracleAnalyzer::checkOnlineRedoLogs() {
         for (Reader *reader : readers) {
             if (reader->group == 0)
@@ -1168,9 +1410,13 @@ namespace OpenLogReplicator {
     ostream& operator<<(ostream& os, const OracleAnalyzer& oracleAnalyzer) {
         if (oracleAnalyzer.xidTransactionMap.size() > 0)
             os << "Transactions open: " << dec << oracleAnalyzer.xidTransactionMap.size() << endl;
-        for (auto it : oracleAnalyzer.xidTransactionMap) {
-            os << "transaction: " << *it.second << endl;
+        vector<Transaction*> transactions;
+        oracleAnalyzer.xidTransactionMap.list(transactions);
+        for (Transaction *transaction : transactions) {
+            os << "transaction: " << *transaction << endl;
         }
+        if (oracleAnalyzer.transactionStats != nullptr)
+            os << "transaction stats: " << *oracleAnalyzer.transactionStats;
         return os;
     }
 }
@@ -17,15 +17,17 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <mutex>
 #include <queue>
 #include <set>
-#include <unordered_map>
 #include <vector>
 
 #include "Thread.h"
+#include "TransactionMap.h"
 
 #ifndef ORACLEANALYZER_H_
 #define ORACLEANALYZER_H_
@@ -34,13 +36,18 @@ using namespace std;
 
 namespace OpenLogReplicator {
 
+    class OpCode;
     class RedoLog;
+    class RedoLogDecoder;
     class OutputBuffer;
     class Reader;
     class RedoLogRecord;
     class Schema;
     class Transaction;
     class TransactionBuffer;
+    class TransactionFormatter;
+    class TransactionSnapshot;
+    class TransactionStats;
 
     struct redoLogCompare {
         bool operator()(RedoLog* const& p1, RedoLog* const& p2);
@@ -105,8 +112,9 @@ namespace OpenLogReplicator {
         string startTime;
         int64_t startTimeRel;
 
-        unordered_map<typeusnslt, Transaction*> xidTransactionMap;
+        TransactionMap xidTransactionMap;
         TransactionBuffer *transactionBuffer;
+        TransactionStats *transactionStats;
         Schema *schema;
         OutputBuffer *outputBuffer;
         ofstream dumpStream;
@@ -116,6 +124,12 @@ namespace OpenLogReplicator {
         uint64_t disableChecks;
         vector<string> pathMapping;
         vector<string> redoLogsBatch;
+        bool skipSession;
+        set<string> skipSessionUser;
+        set<string> skipSessionProgram;
+        set<string> skipSessionTransactionName;
+        set<string> skipSessionClientInfo;
+        set<string> skipSessionClientId;
         uint64_t redoReadSleep;
         uint64_t archReadSleep;
         uint64_t trace;
@@ -127,10 +141,31 @@ namespace OpenLogReplicator {
         typeresetlogs resetlogs;
         typeactivation activation;
         uint64_t isBigEndian;
-        uint64_t suppLogSize;
+        atomic<uint64_t> suppLogSize;
         bool version12;
         void (*archGetLog)(OracleAnalyzer *oracleAnalyzer);
 
+        uint64_t decoderThreads;
+        uint64_t streamTransactionOps;
+        uint64_t snapshotInterval;
+        TransactionSnapshot *transactionSnapshot;
+        vector<RedoLogDecoder*> decoders;
+        mutex decoderMtx;
+        condition_variable decoderCond;
+        condition_variable decoderDoneCond;
+        OpCode **decoderOpCodes;
+        uint64_t decoderOpCodesNum;
+        uint64_t decoderBatch;
+        uint64_t decoderRunning;
+        uint64_t decoderFailedVector;
+        uint64_t formatterThreads;
+        vector<TransactionFormatter*> formatters;
+        deque<TransactionFormatter*> formattersQueue;
+        vector<Transaction*> formattedTransactions;
+        mutex formatterMtx;
+        condition_variable formatterCond;
+        bool formatterFailed;
+
         uint16_t (*read16)(const uint8_t* buf);
         uint32_t (*read32)(const uint8_t* buf);
         uint64_t (*read56)(const uint8_t* buf);
@@ -173,6 +208,14 @@ namespace OpenLogReplicator {
         void initializeSchema(void);
         void *run(void);
         virtual Reader *readerCreate(int64_t group);
+        void decoderCreate(void);
+        void decoderDropAll(void);
+        uint64_t decoderProcess(OpCode **opCodes, uint64_t opCodesNum);
+        void formatterCreate(void);
+        void formatterDropAll(void);
+        bool formatterSubmit(Transaction *transaction);
+        void formatterDrain(void);
+        void formatterRelease(void);
         void checkOnlineRedoLogs();
         bool readerUpdateRedoLog(Reader *reader);
         virtual void doShutdown(void);
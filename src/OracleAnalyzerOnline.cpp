@@ -936,6 +936,7 @@ namespace OpenLogReplicator {
             schema->object->maxSegCol = maxSegCol;
             schema->object->totalPk = totalPk;
             schema->object->updatePK();
+            outputBuffer->updateDecodePlan(schema->object);
             schema->addToDict(schema->object);
             schema->object = nullptr;
 
@@ -39,7 +39,18 @@ namespace OpenLogReplicator {
             storedAsLob(storedAsLob),
             constraint(constraint),
             added(added),
-            guard(guard) {
+            guard(guard),
+            decodeTypeNo(typeNo),
+            characterSet(nullptr) {
+
+        if (storedAsLob) {
+            //varchar2 stored as clob
+            if (typeNo == 1)
+                decodeTypeNo = 112;
+            //raw stored as blob
+            else if (typeNo == 23)
+                decodeTypeNo = 113;
+        }
     }
 
     OracleColumn::~OracleColumn() {
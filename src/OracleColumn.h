@@ -26,6 +26,8 @@ using namespace std;
 
 namespace OpenLogReplicator {
 
+    class CharacterSet;
+
     class OracleColumn {
     public:
         typecol colNo;
@@ -44,6 +46,9 @@ namespace OpenLogReplicator {
         bool constraint;
         bool added;
         bool guard;
+        //decode plan resolved when schema is loaded
+        uint64_t decodeTypeNo;
+        CharacterSet *characterSet;
 
         OracleColumn(typecol colNo, typecol guardSegNo, typecol segColNo, const char *name, uint64_t typeNo, uint64_t length, int64_t precision,
                 int64_t scale, uint64_t numPk, uint64_t charsetId, bool nullable, bool invisible, bool storedAsLob, bool constraint,
@@ -17,6 +17,8 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <algorithm>
+
 #include "CharacterSet16bit.h"
 #include "CharacterSet7bit.h"
 #include "CharacterSet8bit.h"
@@ -44,6 +46,9 @@ namespace OpenLogReplicator {
 
     const char OutputBuffer::map64[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
     const char OutputBuffer::map16[17] = "0123456789abcdef";
+    const char OutputBuffer::map100[201] =
+            "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+            "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
 
     OutputBuffer::OutputBuffer(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
             uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat) :
@@ -61,17 +66,23 @@ namespace OpenLogReplicator {
             lastTime(0),
             lastScn(0),
             lastXid(0),
+            valuesGeneration(1),
             valuesMax(0),
             mergesMax(0),
             id(0),
+            reserveSpill(false),
             defaultCharacterMapId(0),
             defaultCharacterNcharMapId(0),
             writer(nullptr),
             buffersAllocated(0),
             firstBuffer(nullptr),
             lastBuffer(nullptr),
-            curMsg(nullptr) {
+            curMsg(nullptr),
+            provisional(false),
+            compensate(false) {
 
+        memset(valuesGen, 0, sizeof(valuesGen));
+        memset(valuesSet, 0, sizeof(valuesSet));
         characterMap[1] = new CharacterSet7bit("US7ASCII", CharacterSet7bit::unicode_map_US7ASCII);
         characterMap[2] = new CharacterSet8bit("WE8DEC", CharacterSet8bit::unicode_map_WE8DEC);
         characterMap[3] = new CharacterSet8bit("WE8HP", CharacterSet8bit::unicode_map_WE8HP, true);
@@ -827,16 +838,26 @@ namespace OpenLogReplicator {
     }
 
     void OutputBuffer::valuesRelease() {
-        valuesMap.clear();
+        //slots are invalidated by generation, not cleared
+        ++valuesGeneration;
         for (uint64_t i = 0; i < mergesMax; ++i)
             delete[] merges[i];
         mergesMax = 0;
         valuesMax = 0;
     }
 
+    //before and after images exchanged to revert operation
+    void OutputBuffer::valuesSwap() {
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
+            swap(values[i][VALUE_BEFORE], values[i][VALUE_AFTER]);
+            swap(values[i][VALUE_BEFORE_SUPP], values[i][VALUE_AFTER_SUPP]);
+            valuesSet[i] = ((valuesSet[i] & 0x0F0F) << 4) | ((valuesSet[i] >> 4) & 0x0F0F);
+        }
+    }
+
     void OutputBuffer::valueSet(uint64_t type, uint16_t column, uint8_t *data, uint16_t length, uint8_t fb) {
         ColumnValue *value;
-        auto it = valuesMap.find(column);
 
         if ((oracleAnalyzer->trace2 & TRACE2_DML) != 0) {
             stringstream strStr;
@@ -848,43 +869,39 @@ namespace OpenLogReplicator {
             TRACE(TRACE2_DML, strStr.str());
         }
 
+        if (column >= MAX_NO_COLUMNS) {
+            RUNTIME_FAIL("column number " << dec << column << " out of range (max: " << MAX_NO_COLUMNS << ")");
+        }
+
         //not set yet
-        if (it != valuesMap.end()) {
-            uint16_t valuePos = (*it).second;
-            value = &values[valuePos][type];
-        } else {
-            memset(&values[valuesMax][VALUE_BEFORE], 0, sizeof(struct ColumnValue));
-            memset(&values[valuesMax][VALUE_AFTER], 0, sizeof(struct ColumnValue));
-            memset(&values[valuesMax][VALUE_BEFORE_SUPP], 0, sizeof(struct ColumnValue));
-            memset(&values[valuesMax][VALUE_AFTER_SUPP], 0, sizeof(struct ColumnValue));
-            value = &values[valuesMax][type];
-            valuesMap[column] = valuesMax++;
+        if (valuesGen[column] != valuesGeneration) {
+            valuesSet[column] = 0;
+            valuesGen[column] = valuesGeneration;
+            valuesCols[valuesMax++] = column;
         }
+        value = &values[column][type];
 
+        uint64_t piece;
         switch (fb & (FB_P | FB_N)) {
         case 0:
-            value->length[0] = length;
-            value->data[0] = data;
+            piece = 0;
             break;
 
         case FB_N:
-            value->length[1] = length;
-            value->data[1] = data;
-            value->merge = true;
+            piece = 1;
             break;
 
         case FB_P | FB_N:
-            value->length[2] = length;
-            value->data[2] = data;
-            value->merge = true;
+            piece = 2;
             break;
 
-        case FB_P:
-            value->length[3] = length;
-            value->data[3] = data;
-            value->merge = true;
+        default:
+            piece = 3;
             break;
         }
+        value->length[piece] = length;
+        value->data[piece] = data;
+        valuesSet[column] |= 1 << (type * 4 + piece);
     }
 
     void OutputBuffer::outputBufferRotate(bool copy) {
@@ -933,9 +950,67 @@ namespace OpenLogReplicator {
         curMsg->oracleAnalyzer = oracleAnalyzer;
         curMsg->pos = 0;
         curMsg->flags = 0;
+        curMsg->keyLength = 0;
         curMsg->data = lastBuffer->data + lastBuffer->length;
     }
 
+    //key of one row message: primary key (or configured key) column values in hex, separated by ':', rowid for tables without key
+    void OutputBuffer::outputBufferKey(OracleObject *object, typedba bdba, typeslot slot, uint64_t type, uint64_t fallback) {
+        if (object == nullptr)
+            return;
+
+        if (object->pk.size() == 0) {
+            uint32_t afn = bdba >> 22;
+            bdba &= 0x003FFFFF;
+            outputBufferAppend(map64[(object->objd >> 30) & 0x3F]);
+            outputBufferAppend(map64[(object->objd >> 24) & 0x3F]);
+            outputBufferAppend(map64[(object->objd >> 18) & 0x3F]);
+            outputBufferAppend(map64[(object->objd >> 12) & 0x3F]);
+            outputBufferAppend(map64[(object->objd >> 6) & 0x3F]);
+            outputBufferAppend(map64[object->objd & 0x3F]);
+            outputBufferAppend(map64[(afn >> 12) & 0x3F]);
+            outputBufferAppend(map64[(afn >> 6) & 0x3F]);
+            outputBufferAppend(map64[afn & 0x3F]);
+            outputBufferAppend(map64[(bdba >> 30) & 0x3F]);
+            outputBufferAppend(map64[(bdba >> 24) & 0x3F]);
+            outputBufferAppend(map64[(bdba >> 18) & 0x3F]);
+            outputBufferAppend(map64[(bdba >> 12) & 0x3F]);
+            outputBufferAppend(map64[(bdba >> 6) & 0x3F]);
+            outputBufferAppend(map64[bdba & 0x3F]);
+            outputBufferAppend(map64[(slot >> 12) & 0x3F]);
+            outputBufferAppend(map64[(slot >> 6) & 0x3F]);
+            outputBufferAppend(map64[slot & 0x3F]);
+            curMsg->keyLength = messageLength;
+            return;
+        }
+
+        for (uint64_t n = 0; n < object->pk.size(); ++n) {
+            uint16_t i = object->pk[n];
+            const uint8_t *data = nullptr;
+            uint64_t length = 0;
+
+            if (n > 0)
+                outputBufferAppend(':');
+
+            if (valuesGen[i] == valuesGeneration) {
+                if (valuePresent(i, type)) {
+                    data = values[i][type].data[0];
+                    length = values[i][type].length[0];
+                } else if (valuePresent(i, fallback)) {
+                    data = values[i][fallback].data[0];
+                    length = values[i][fallback].length[0];
+                }
+            }
+
+            for (uint64_t j = 0; j < length; ++j) {
+                outputBufferAppend(map16[data[j] >> 4]);
+                outputBufferAppend(map16[data[j] & 0x0F]);
+            }
+        }
+
+        curMsg->keyLength = messageLength;
+    }
+
     void OutputBuffer::outputBufferCommit(void) {
         if (messageLength == 0) {
             WARNING("JSON buffer - commit of empty transaction");
@@ -958,23 +1033,69 @@ namespace OpenLogReplicator {
     }
 
     void OutputBuffer::outputBufferAppend(string &str) {
-        const char *charstr = str.c_str();
-        uint64_t length = str.length();
-        for (uint i = 0; i < length; ++i)
-            outputBufferAppend(*charstr++);
+        outputBufferAppend((const uint8_t*)str.c_str(), str.length());
     }
 
     void OutputBuffer::outputBufferAppend(const char *str) {
-        char character = *str++;
-        while (character != 0) {
-            outputBufferAppend(character);
-            character = *str++;
-        }
+        outputBufferAppend((const uint8_t*)str, strlen(str));
     }
 
     void OutputBuffer::outputBufferAppend(const char *str, uint64_t length) {
-        for (uint i = 0; i < length; ++i)
-            outputBufferAppend(*str++);
+        outputBufferAppend((const uint8_t*)str, length);
+    }
+
+    void OutputBuffer::outputBufferAppend(const uint8_t *data, uint64_t length) {
+        while (length > 0) {
+            uint64_t size = OUTPUT_BUFFER_DATA_SIZE - lastBuffer->length;
+            if (size > length)
+                size = length;
+            memcpy(lastBuffer->data + lastBuffer->length, data, size);
+            messageLength += size;
+            data += size;
+            length -= size;
+            outputBufferShift(size, true);
+        }
+    }
+
+    //space for a value of up to length bytes, the value is written at once and confirmed with outputBufferReserveCommit
+    uint8_t *OutputBuffer::outputBufferReserve(uint64_t length) {
+        if (lastBuffer->length + length < OUTPUT_BUFFER_DATA_SIZE) {
+            reserveSpill = false;
+            return lastBuffer->data + lastBuffer->length;
+        }
+
+        if (length > OUTPUT_BUFFER_RESERVE_SIZE) {
+            RUNTIME_FAIL("output buffer reserve of " << dec << length << " bytes exceeds " << OUTPUT_BUFFER_RESERVE_SIZE);
+        }
+
+        //message continues in next buffer, the value is copied there on commit
+        reserveSpill = true;
+        return reserveBuffer;
+    }
+
+    void OutputBuffer::outputBufferReserveCommit(uint64_t length) {
+        if (reserveSpill) {
+            reserveSpill = false;
+            outputBufferAppend(reserveBuffer, length);
+            return;
+        }
+
+        lastBuffer->length += length;
+        messageLength += length;
+    }
+
+    void OutputBuffer::outputBufferReset(void) {
+        while (firstBuffer->next != nullptr) {
+            OutputBufferQueue* nextBuffer = firstBuffer->next->next;
+            oracleAnalyzer->freeMemoryChunk("BUFFER", (uint8_t*)firstBuffer->next, true);
+            firstBuffer->next = nextBuffer;
+            --buffersAllocated;
+        }
+        firstBuffer->length = 0;
+        lastBuffer = firstBuffer;
+        curMsg = nullptr;
+        messageLength = 0;
+        id = 0;
     }
 
     void OutputBuffer::columnUnknown(string &columnName, const uint8_t *data, uint64_t length) {
@@ -1007,31 +1128,105 @@ namespace OpenLogReplicator {
         };
     }
 
-    void OutputBuffer::processValue(OracleColumn *column, const uint8_t *data, uint64_t length, uint64_t typeNo, uint64_t charsetId) {
+    //NUMBER without fraction part, fitting in 9 base-100 digits
+    bool OutputBuffer::numberToInt(const uint8_t *data, uint64_t length, int64_t &value) {
+        uint8_t digits = data[0];
+        uint64_t jMax = length - 1, groups, result = 0;
+
+        if (digits == 0x80) {
+            value = 0;
+            return true;
+        }
+
+        //positive number
+        if (digits > 0xC0 && jMax >= 1) {
+            groups = digits - 0xC0;
+            if (groups > 9 || jMax > groups)
+                return false;
+
+            for (uint64_t j = 1; j <= jMax; ++j) {
+                uint64_t digit = data[j] - 1;
+                if (digit > 99)
+                    return false;
+                result = result * 100 + digit;
+            }
+            for (uint64_t j = jMax; j < groups; ++j)
+                result *= 100;
+
+            value = result;
+            return true;
+
+        //negative number
+        } else if (digits < 0x3F && jMax >= 1) {
+            if (data[jMax] == 0x66)
+                --jMax;
+            groups = 0x3F - digits;
+            if (jMax < 1 || groups > 9 || jMax > groups)
+                return false;
+
+            for (uint64_t j = 1; j <= jMax; ++j) {
+                uint64_t digit = 101 - data[j];
+                if (digit > 99)
+                    return false;
+                result = result * 100 + digit;
+            }
+            for (uint64_t j = jMax; j < groups; ++j)
+                result *= 100;
+
+            value = -(int64_t)result;
+            return true;
+        }
+
+        return false;
+    }
+
+    //days since 1970-01-01 of proleptic Gregorian date, month 1..12
+    int64_t OutputBuffer::epochDay(int64_t year, int64_t month, int64_t day) {
+        if (month <= 2)
+            --year;
+        int64_t era = (year >= 0 ? year : year - 399) / 400;
+        int64_t yearOfEra = year - era * 400;
+        int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    //character sets are shared by all formatters, decode does not change state
+    void OutputBuffer::updateDecodePlan(OracleObject *object) {
+        for (OracleColumn *column : object->columns) {
+            if (column == nullptr)
+                continue;
+
+            column->characterSet = nullptr;
+            if (column->decodeTypeNo == 1 || column->decodeTypeNo == 96) {
+                auto it = characterMap.find(column->charsetId);
+                if (it != characterMap.end())
+                    column->characterSet = (*it).second;
+            }
+        }
+    }
+
+    void OutputBuffer::processValue(OracleColumn *column, const uint8_t *data, uint64_t length) {
         uint8_t digits;
-        CharacterSet *characterSet = nullptr;
+        CharacterSet *characterSet = column->characterSet;
         if (length == 0) {
             RUNTIME_FAIL("ERROR, trying to output null data for column: " << column->name);
         }
 
-        if (column->storedAsLob) {
-            //varchar2 stored as clob
-            if (typeNo == 1)
-                typeNo = 112;
-            //raw stored as blob
-            else if (typeNo == 23)
-                typeNo = 113;
-        }
-
-        switch(typeNo) {
+        switch(column->decodeTypeNo) {
         case 1: //varchar2/nvarchar2
         case 96: //char/nchar
-            characterSet = characterMap[charsetId];
             if (characterSet == nullptr && (charFormat & CHAR_FORMAT_NOMAPPING) == 0) {
-                RUNTIME_FAIL("can't find character set map for id = " << dec << charsetId);
+                RUNTIME_FAIL("can't find character set map for id = " << dec << column->charsetId);
             }
             valueLength = 0;
 
+            //whole value at once, up to 4 bytes of UTF-8 per source byte
+            if ((charFormat & (CHAR_FORMAT_NOMAPPING | CHAR_FORMAT_HEX)) == 0 && length * 4 <= MAX_FIELD_LENGTH) {
+                valueLength = characterSet->transcode(data, length, (uint8_t*)valueBuffer);
+                length = 0;
+            }
+
             while (length > 0) {
                 typeunicode unicodeCharacter;
                 uint64_t unicodeCharacterLength;
@@ -1079,6 +1274,13 @@ namespace OpenLogReplicator {
             break;
 
         case 2: //number/float
+            {
+                int64_t value;
+                if (numberToInt(data, length, value)) {
+                    columnInt(column->name, column->precision, column->scale, value);
+                    break;
+                }
+            }
             valueLength = 0;
 
             digits = data[0];
@@ -1394,6 +1596,54 @@ namespace OpenLogReplicator {
         }
     }
 
+    //copy complete messages of a formatter (in the same layout as read by Writer) to the end of the queue
+    void OutputBuffer::outputBufferSplice(OutputBuffer *formatter) {
+        OutputBufferQueue *buffer = formatter->firstBuffer;
+        uint64_t pos = 0;
+
+        for (uint64_t i = 0; i < formatter->id; ++i) {
+            if (buffer->length == pos && buffer->next != nullptr) {
+                buffer = buffer->next;
+                pos = 0;
+            }
+
+            OutputBufferMsg *msg = (OutputBufferMsg *)(buffer->data + pos);
+            uint64_t length = msg->length, length8 = (length + 7) & 0xFFFFFFFFFFFFFFF8;
+            pos += sizeof(struct OutputBufferMsg);
+
+            outputBufferBegin(msg->dictId);
+            curMsg->scn = msg->scn;
+            curMsg->keyLength = msg->keyLength;
+
+            //message in one part
+            if (pos + length8 <= OUTPUT_BUFFER_DATA_SIZE) {
+                outputBufferAppend(buffer->data + pos, length);
+                pos += length8;
+
+            //message in many parts
+            } else {
+                uint64_t copied = 0;
+                while (length - copied > 0) {
+                    uint64_t toCopy = length - copied;
+                    if (toCopy > buffer->length - pos) {
+                        toCopy = buffer->length - pos;
+                        outputBufferAppend(buffer->data + pos, toCopy);
+                        buffer = buffer->next;
+                        pos = 0;
+                    } else {
+                        outputBufferAppend(buffer->data + pos, toCopy);
+                        pos += (toCopy + 7) & 0xFFFFFFFFFFFFFFF8;
+                    }
+                    copied += toCopy;
+                }
+            }
+
+            outputBufferCommit();
+        }
+
+        formatter->outputBufferReset();
+    }
+
     //0x05010B0B
     void OutputBuffer::processInsertMultiple(RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2) {
         uint64_t pos = 0, fieldPos = 0, fieldNum = 0, fieldPosStart;
@@ -1435,12 +1685,16 @@ namespace OpenLogReplicator {
                     }
                 }
 
-                valueSet(VALUE_AFTER, i, redoLogRecord2->data + fieldPos + pos, colLength, 0);
+                valueSet(compensate ? VALUE_BEFORE : VALUE_AFTER, i, redoLogRecord2->data + fieldPos + pos, colLength, 0);
                 pos += colLength;
             }
 
-            processInsert(object, redoLogRecord2->bdba,
-                    oracleAnalyzer->read16(redoLogRecord2->data + redoLogRecord2->slotsDelta + r * 2), redoLogRecord1->xid);
+            if (compensate)
+                processDelete(object, redoLogRecord2->bdba,
+                        oracleAnalyzer->read16(redoLogRecord2->data + redoLogRecord2->slotsDelta + r * 2), redoLogRecord1->xid);
+            else
+                processInsert(object, redoLogRecord2->bdba,
+                        oracleAnalyzer->read16(redoLogRecord2->data + redoLogRecord2->slotsDelta + r * 2), redoLogRecord1->xid);
             valuesRelease();
 
             fieldPosStart += oracleAnalyzer->read16(redoLogRecord2->data + redoLogRecord2->rowLenghsDelta + r * 2);
@@ -1488,12 +1742,16 @@ namespace OpenLogReplicator {
                     }
                 }
 
-                valueSet(VALUE_BEFORE, i, redoLogRecord1->data + fieldPos + pos, colLength, 0);
+                valueSet(compensate ? VALUE_AFTER : VALUE_BEFORE, i, redoLogRecord1->data + fieldPos + pos, colLength, 0);
                 pos += colLength;
             }
 
-            processDelete(object, redoLogRecord2->bdba,
-                    oracleAnalyzer->read16(redoLogRecord1->data + redoLogRecord1->slotsDelta + r * 2), redoLogRecord1->xid);
+            if (compensate)
+                processInsert(object, redoLogRecord2->bdba,
+                        oracleAnalyzer->read16(redoLogRecord1->data + redoLogRecord1->slotsDelta + r * 2), redoLogRecord1->xid);
+            else
+                processDelete(object, redoLogRecord2->bdba,
+                        oracleAnalyzer->read16(redoLogRecord1->data + redoLogRecord1->slotsDelta + r * 2), redoLogRecord1->xid);
             valuesRelease();
 
             fieldPosStart += oracleAnalyzer->read16(redoLogRecord1->data + redoLogRecord1->rowLenghsDelta + r * 2);
@@ -1726,29 +1984,28 @@ namespace OpenLogReplicator {
             redoLogRecord2p = redoLogRecord2p->next;
         }
 
+        //columns are output in column order
+        sort(valuesCols, valuesCols + valuesMax);
+
         int16_t guardPos = -1;
-        if (object->guardSegNo != -1) {
-            auto it = valuesMap.find(object->guardSegNo);
-            if (it != valuesMap.end())
-                guardPos = (*it).second;
-        }
+        if (object->guardSegNo != -1 && valuesGen[object->guardSegNo] == valuesGeneration)
+            guardPos = object->guardSegNo;
 
-        for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-            uint16_t i = (*it).first;
-            uint16_t pos = (*it).second;
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
 
             for (uint64_t j = 0; j < 4; ++j) {
-                if (values[pos][j].merge) {
+                if (valueMerge(i, j)) {
                     uint64_t length = 0;
 
-                    if (values[pos][j].data[1] != nullptr)
-                        length += values[pos][j].length[1];
-                    if (values[pos][j].data[2] != nullptr)
-                        length += values[pos][j].length[2];
-                    if (values[pos][j].data[3] != nullptr)
-                        length += values[pos][j].length[3];
+                    if (valuePresent(i, j, 1))
+                        length += values[i][j].length[1];
+                    if (valuePresent(i, j, 2))
+                        length += values[i][j].length[2];
+                    if (valuePresent(i, j, 3))
+                        length += values[i][j].length[3];
 
-                    if (values[pos][j].data[0] != nullptr) {
+                    if (valuePresent(i, j)) {
                         RUNTIME_FAIL("value for " << j << " is already set when merging");
                     }
 
@@ -1758,63 +2015,66 @@ namespace OpenLogReplicator {
                     }
                     merges[mergesMax++] = buffer;
 
-                    values[pos][j].data[0] = buffer;
-                    values[pos][j].length[0] = length;
+                    values[i][j].data[0] = buffer;
+                    values[i][j].length[0] = length;
+                    valuesSet[i] |= 1 << (j * 4);
 
-                    if (values[pos][j].data[1] != nullptr) {
-                        memcpy(buffer, values[pos][j].data[1], values[pos][j].length[1]);
-                        buffer += values[pos][j].length[1];
+                    if (valuePresent(i, j, 1)) {
+                        memcpy(buffer, values[i][j].data[1], values[i][j].length[1]);
+                        buffer += values[i][j].length[1];
                     }
-                    if (values[pos][j].data[2] != nullptr) {
-                        memcpy(buffer, values[pos][j].data[2], values[pos][j].length[2]);
-                        buffer += values[pos][j].length[2];
+                    if (valuePresent(i, j, 2)) {
+                        memcpy(buffer, values[i][j].data[2], values[i][j].length[2]);
+                        buffer += values[i][j].length[2];
                     }
-                    if (values[pos][j].data[3] != nullptr) {
-                        memcpy(buffer, values[pos][j].data[3], values[pos][j].length[3]);
-                        buffer += values[pos][j].length[3];
+                    if (valuePresent(i, j, 3)) {
+                        memcpy(buffer, values[i][j].data[3], values[i][j].length[3]);
+                        buffer += values[i][j].length[3];
                     }
                 }
             }
 
-            if (values[pos][VALUE_BEFORE].data[0] == nullptr) {
+            if (!valuePresent(i, VALUE_BEFORE)) {
                 bool guardPresent = false;
                 if (object->columns[i]->guardSegNo != -1 && guardPos != -1) {
-                    uint8_t *guardData = values[guardPos][VALUE_BEFORE].data[0];
-                    if (guardData != nullptr) {
+                    if (valuePresent(guardPos, VALUE_BEFORE)) {
                         guardPresent = true;
                         uint64_t guardLength = values[guardPos][VALUE_BEFORE].length[0];
                         uint64_t guardPos = i / 8;
                         if (guardPos < guardLength && (values[guardPos][VALUE_BEFORE].data[0][guardPos] & (1 << (i & 7))) != 0) {
-                            values[pos][VALUE_BEFORE].data[0] = (uint8_t*)1;
-                            values[pos][VALUE_BEFORE].length[0] = 0;
+                            values[i][VALUE_BEFORE].data[0] = nullptr;
+                            values[i][VALUE_BEFORE].length[0] = 0;
+                            valuesSet[i] |= 1 << (VALUE_BEFORE * 4);
                         }
                     }
                 }
 
-                if (!guardPresent && values[pos][VALUE_BEFORE_SUPP].data[0] != nullptr) {
-                    values[pos][VALUE_BEFORE].data[0] = values[pos][VALUE_BEFORE_SUPP].data[0];
-                    values[pos][VALUE_BEFORE].length[0] = values[pos][VALUE_BEFORE_SUPP].length[0];
+                if (!guardPresent && valuePresent(i, VALUE_BEFORE_SUPP)) {
+                    values[i][VALUE_BEFORE].data[0] = values[i][VALUE_BEFORE_SUPP].data[0];
+                    values[i][VALUE_BEFORE].length[0] = values[i][VALUE_BEFORE_SUPP].length[0];
+                    valuesSet[i] |= 1 << (VALUE_BEFORE * 4);
                 }
             }
 
-            if (values[pos][VALUE_AFTER].data[0] == nullptr) {
+            if (!valuePresent(i, VALUE_AFTER)) {
                 bool guardPresent = false;
                 if (object->columns[i]->guardSegNo != -1 && guardPos != -1) {
-                    uint8_t *guardData = values[guardPos][VALUE_AFTER].data[0];
-                    if (guardData != nullptr) {
+                    if (valuePresent(guardPos, VALUE_AFTER)) {
                         guardPresent = true;
                         uint64_t guardLength = values[guardPos][VALUE_AFTER].length[0];
                         uint64_t guardPos = i / 8;
                         if (guardPos < guardLength && (values[guardPos][VALUE_AFTER].data[0][guardPos] & (1 << (i & 7))) != 0) {
-                            values[pos][VALUE_AFTER].data[0] = (uint8_t*)1;
-                            values[pos][VALUE_AFTER].length[0] = 0;
+                            values[i][VALUE_AFTER].data[0] = nullptr;
+                            values[i][VALUE_AFTER].length[0] = 0;
+                            valuesSet[i] |= 1 << (VALUE_AFTER * 4);
                         }
                     }
                 }
 
-                if (!guardPresent && values[pos][VALUE_AFTER_SUPP].data[0] != nullptr) {
-                    values[pos][VALUE_AFTER].data[0] = values[pos][VALUE_AFTER_SUPP].data[0];
-                    values[pos][VALUE_AFTER].length[0] = values[pos][VALUE_AFTER_SUPP].length[0];
+                if (!guardPresent && valuePresent(i, VALUE_AFTER_SUPP)) {
+                    values[i][VALUE_AFTER].data[0] = values[i][VALUE_AFTER_SUPP].data[0];
+                    values[i][VALUE_AFTER].length[0] = values[i][VALUE_AFTER_SUPP].length[0];
+                    valuesSet[i] |= 1 << (VALUE_AFTER * 4);
                 }
             }
         }
@@ -1822,70 +2082,82 @@ namespace OpenLogReplicator {
         if ((oracleAnalyzer->trace2 & TRACE2_DML) != 0) {
             TRACE(TRACE2_DML, "tab: " << object->owner << "." << object->name << " type: " << type);
 
-            for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-                uint16_t i = (*it).first;
-                uint16_t pos = (*it).second;
+            for (uint64_t n = 0; n < valuesMax; ++n) {
+                uint16_t i = valuesCols[n];
 
                 TRACE(TRACE2_DML, dec << i << ": " <<
-                        " B(" << dec << values[pos][VALUE_BEFORE].length[0] << ")" <<
-                        " A(" << dec << values[pos][VALUE_AFTER].length[0] << ")" <<
-                        " BS(" << dec << values[pos][VALUE_BEFORE_SUPP].length[0] << ")" <<
-                        " AS(" << dec << values[pos][VALUE_AFTER_SUPP].length[0] << ")" <<
+                        " B(" << dec << values[i][VALUE_BEFORE].length[0] << ")" <<
+                        " A(" << dec << values[i][VALUE_AFTER].length[0] << ")" <<
+                        " BS(" << dec << values[i][VALUE_BEFORE_SUPP].length[0] << ")" <<
+                        " AS(" << dec << values[i][VALUE_AFTER_SUPP].length[0] << ")" <<
                         " pk: " << dec << object->columns[i]->numPk);
             }
         }
 
+        //operation already sent as provisional message is reverted
+        if (compensate) {
+            valuesSwap();
+            if (type == TRANSACTION_INSERT)
+                type = TRANSACTION_DELETE;
+            else if (type == TRANSACTION_DELETE)
+                type = TRANSACTION_INSERT;
+        }
+
         if (type == TRANSACTION_UPDATE) {
             if (columnFormat < COLUMN_FORMAT_FULL) {
-                for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ) {
-                    uint16_t i = (*it).first;
-                    uint16_t pos = (*it).second;
+                uint64_t kept = 0;
+                for (uint64_t n = 0; n < valuesMax; ++n) {
+                    uint16_t i = valuesCols[n];
 
                     //remove unchanged column values - only for tables with defined primary key
-                    if (object->columns[i]->numPk == 0 && values[pos][VALUE_BEFORE].data[0] != nullptr && values[pos][VALUE_AFTER].data[0] != nullptr && values[pos][VALUE_BEFORE].length[0] == values[pos][VALUE_AFTER].length[0]) {
-                        if (values[pos][VALUE_BEFORE].length[0] == 0 || memcmp(values[pos][VALUE_BEFORE].data[0], values[pos][VALUE_AFTER].data[0], values[pos][VALUE_BEFORE].length[0]) == 0) {
-                            it = valuesMap.erase(it);
+                    if (object->columns[i]->numPk == 0 && valuePresent(i, VALUE_BEFORE) && valuePresent(i, VALUE_AFTER) && values[i][VALUE_BEFORE].length[0] == values[i][VALUE_AFTER].length[0]) {
+                        if (values[i][VALUE_BEFORE].length[0] == 0 || memcmp(values[i][VALUE_BEFORE].data[0], values[i][VALUE_AFTER].data[0], values[i][VALUE_BEFORE].length[0]) == 0) {
                             continue;
                         }
                     }
 
                     //remove columns additionally present, but not modified
-                    if (values[pos][VALUE_BEFORE].data[0] != nullptr && values[pos][VALUE_BEFORE].length[0] == 0 && values[pos][VALUE_AFTER].data[0] == nullptr) {
+                    if (valuePresent(i, VALUE_BEFORE) && values[i][VALUE_BEFORE].length[0] == 0 && !valuePresent(i, VALUE_AFTER)) {
                         if (object->columns[i]->numPk == 0) {
-                            values[pos][VALUE_BEFORE].data[0] = nullptr;
+                            valuesSet[i] &= ~(1 << (VALUE_BEFORE * 4));
                         } else {
-                            values[pos][VALUE_AFTER].data[0] = values[pos][VALUE_BEFORE].data[0];
-                            values[pos][VALUE_AFTER].length[0] = values[pos][VALUE_BEFORE].length[0];
+                            values[i][VALUE_AFTER].data[0] = values[i][VALUE_BEFORE].data[0];
+                            values[i][VALUE_AFTER].length[0] = values[i][VALUE_BEFORE].length[0];
+                            valuesSet[i] |= 1 << (VALUE_AFTER * 4);
                         }
                     }
 
-                    if (values[pos][VALUE_AFTER].data[0] != nullptr && values[pos][VALUE_AFTER].length[0] == 0 && values[pos][VALUE_BEFORE].data[0] == nullptr) {
+                    if (valuePresent(i, VALUE_AFTER) && values[i][VALUE_AFTER].length[0] == 0 && !valuePresent(i, VALUE_BEFORE)) {
                         if (object->columns[i]->numPk == 0) {
-                            values[pos][VALUE_AFTER].data[0] = nullptr;
+                            valuesSet[i] &= ~(1 << (VALUE_AFTER * 4));
                         } else {
-                            values[pos][VALUE_BEFORE].data[0] = values[pos][VALUE_AFTER].data[0];
-                            values[pos][VALUE_BEFORE].length[0] = values[pos][VALUE_AFTER].length[0];
+                            values[i][VALUE_BEFORE].data[0] = values[i][VALUE_AFTER].data[0];
+                            values[i][VALUE_BEFORE].length[0] = values[i][VALUE_AFTER].length[0];
+                            valuesSet[i] |= 1 << (VALUE_BEFORE * 4);
                         }
                     }
-                    ++it;
+                    valuesCols[kept++] = i;
                 }
+                valuesMax = kept;
             }
 
             processUpdate(object, bdba, slot, redoLogRecord1->xid);
         } else {
             //assume null values for missing columns
+            uint64_t valuesOld = valuesMax;
             for (uint16_t i: object->pk ) {
-                auto it = valuesMap.find(i);
-                if (it == valuesMap.end()) {
-                    memset(&values[valuesMax][VALUE_BEFORE], 0, sizeof(struct ColumnValue));
-                    memset(&values[valuesMax][VALUE_AFTER], 0, sizeof(struct ColumnValue));
-                    memset(&values[valuesMax][VALUE_BEFORE_SUPP], 0, sizeof(struct ColumnValue));
-                    memset(&values[valuesMax][VALUE_AFTER_SUPP], 0, sizeof(struct ColumnValue));
-                    values[valuesMax][VALUE_BEFORE].data[0] = (uint8_t*)1;
-                    values[valuesMax][VALUE_AFTER].data[0] = (uint8_t*)1;
-                    valuesMap[i] = valuesMax++;
+                if (valuesGen[i] != valuesGeneration) {
+                    values[i][VALUE_BEFORE].data[0] = nullptr;
+                    values[i][VALUE_BEFORE].length[0] = 0;
+                    values[i][VALUE_AFTER].data[0] = nullptr;
+                    values[i][VALUE_AFTER].length[0] = 0;
+                    valuesSet[i] = (1 << (VALUE_BEFORE * 4)) | (1 << (VALUE_AFTER * 4));
+                    valuesGen[i] = valuesGeneration;
+                    valuesCols[valuesMax++] = i;
                 }
             }
+            if (valuesMax != valuesOld)
+                sort(valuesCols, valuesCols + valuesMax);
 
             if (type == TRANSACTION_INSERT)
                 processInsert(object, bdba, slot, redoLogRecord1->xid);
@@ -1948,4 +2220,8 @@ namespace OpenLogReplicator {
         else
             processDDL(object, type, seq, "?", sqlText, sqlLength - 1);
     }
+
+    //called by the analyzer between LWNs and while waiting for redo data, for formats which buffer rows across transactions
+    void OutputBuffer::processPoll(void) {
+    }
 }
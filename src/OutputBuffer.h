@@ -42,7 +42,6 @@ namespace OpenLogReplicator {
     struct ColumnValue {
         uint16_t length[4];
         uint8_t *data[4];
-        bool merge;
     };
 
     struct OutputBufferQueue {
@@ -62,12 +61,14 @@ namespace OpenLogReplicator {
         uint32_t dictId;
         uint16_t pos;
         uint16_t flags;
+        uint32_t keyLength;                         //message key stored in front of data, payload follows
     };
 
     class OutputBuffer {
     protected:
         static const char map64[65];
         static const char map16[17];
+        static const char map100[201];
         OracleAnalyzer *oracleAnalyzer;
         uint64_t messageFormat;
         uint64_t xidFormat;
@@ -85,34 +86,53 @@ namespace OpenLogReplicator {
         typetime lastTime;
         typescn lastScn;
         typexid lastXid;
-        map<uint16_t, uint16_t> valuesMap;
-        ColumnValue values[MAX_NO_COLUMNS][4];
+        ColumnValue values[MAX_NO_COLUMNS][4];     //indexed by column number, valid when valuesGen matches valuesGeneration
+        uint16_t valuesSet[MAX_NO_COLUMNS];         //bit (type * 4 + piece) set when values[column][type] piece is present
+        uint64_t valuesGen[MAX_NO_COLUMNS];
+        uint64_t valuesGeneration;
+        uint16_t valuesCols[MAX_NO_COLUMNS];        //columns set for current row
         uint8_t *merges[MAX_NO_COLUMNS*4];
         uint64_t valuesMax;
         uint64_t mergesMax;
         uint64_t id;
+        uint8_t reserveBuffer[OUTPUT_BUFFER_RESERVE_SIZE];
+        bool reserveSpill;
 
         void valuesRelease();
+        void valuesSwap();
+        bool valuePresent(uint16_t column, uint64_t type, uint64_t piece = 0) const {
+            return (valuesSet[column] & (1 << (type * 4 + piece))) != 0;
+        }
+        bool valueMerge(uint16_t column, uint64_t type) const {
+            return (valuesSet[column] & (0xE << (type * 4))) != 0;
+        }
         void valueSet(uint64_t type, uint16_t column, uint8_t *data, uint16_t length, uint8_t fb);
         void outputBufferRotate(bool copy);
         void outputBufferShift(uint64_t bytes, bool copy);
         void outputBufferBegin(uint32_t dictId);
+        void outputBufferKey(OracleObject *object, typedba bdba, typeslot slot, uint64_t type, uint64_t fallback);
         void outputBufferCommit(void);
         void outputBufferAppend(char character);
         void outputBufferAppend(const char* str, uint64_t length);
         void outputBufferAppend(const char* str);
         void outputBufferAppend(string &str);
+        void outputBufferAppend(const uint8_t *data, uint64_t length);
+        uint8_t *outputBufferReserve(uint64_t length);
+        void outputBufferReserveCommit(uint64_t length);
         void columnUnknown(string &columnName, const uint8_t *data, uint64_t length);
         virtual void columnNull(OracleColumn *column) = 0;
         virtual void columnFloat(string &columnName, float value) = 0;
         virtual void columnDouble(string &columnName, double value) = 0;
         virtual void columnString(string &columnName) = 0;
         virtual void columnNumber(string &columnName, uint64_t precision, uint64_t scale) = 0;
+        virtual void columnInt(string &columnName, uint64_t precision, uint64_t scale, int64_t value) = 0;
         virtual void columnRaw(string &columnName, const uint8_t *data, uint64_t length) = 0;
         virtual void columnTimestamp(string &columnName, struct tm &time, uint64_t fraction, const char *tz) = 0;
         void valueBufferAppend(uint8_t value);
         void valueBufferAppendHex(typeunicode value, uint64_t length);
-        void processValue(OracleColumn *column, const uint8_t *data, uint64_t length, uint64_t typeNo, uint64_t charsetId);
+        bool numberToInt(const uint8_t *data, uint64_t length, int64_t &value);
+        static int64_t epochDay(int64_t year, int64_t month, int64_t day);
+        void processValue(OracleColumn *column, const uint8_t *data, uint64_t length);
         virtual void appendRowid(typeobj objn, typeobj objd, typedba bdba, typeslot slot) = 0;
         virtual void appendHeader(bool first) = 0;
         virtual void appendSchema(OracleObject *object) = 0;
@@ -129,6 +149,8 @@ namespace OpenLogReplicator {
         OutputBufferQueue *firstBuffer;
         OutputBufferQueue *lastBuffer;
         OutputBufferMsg *curMsg;
+        bool provisional;
+        bool compensate;
 
         OutputBuffer(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
                 uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat);
@@ -138,9 +160,15 @@ namespace OpenLogReplicator {
         uint64_t outputBufferSize(void);
         void setWriter(Writer *writer);
         void setNlsCharset(string &nlsCharset, string &nlsNcharCharset);
+        void outputBufferReset(void);
+        void updateDecodePlan(OracleObject *object);
+        void outputBufferSplice(OutputBuffer *formatter);
+
+        virtual OutputBuffer *newFormatter(void) = 0;
 
         virtual void processBegin(typescn scn, typetime time, typexid xid) = 0;
         virtual void processCommit(void) = 0;
+        virtual void processRollback(typescn scn, typetime time, typexid xid) = 0;
         virtual void processInsert(OracleObject *object, typedba bdba, typeslot slot, typexid xid) = 0;
         virtual void processUpdate(OracleObject *object, typedba bdba, typeslot slot, typexid xid) = 0;
         virtual void processDelete(OracleObject *object, typedba bdba, typeslot slot, typexid xid) = 0;
@@ -149,6 +177,7 @@ namespace OpenLogReplicator {
         void processDeleteMultiple(RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2);
         void processDML(RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2, uint64_t type);
         void processDDLheader(RedoLogRecord *redoLogRecord1);
+        virtual void processPoll(void);
         //virtual void processCheckpoint(typescn scn, typetime time) = 0;
         //virtual void processSwitch(typescn scn, typetime time) = 0;
     };
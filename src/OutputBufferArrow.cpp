@@ -0,0 +1,642 @@
+/* Memory buffer for handling output data in Arrow IPC format
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+
+#include "OracleAnalyzer.h"
+#include "OracleColumn.h"
+#include "OracleObject.h"
+#include "OutputBufferArrow.h"
+#include "RuntimeException.h"
+
+namespace OpenLogReplicator {
+
+    OutputBufferArrow::OutputBufferArrow(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
+            uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat, uint64_t batchRows, uint64_t batchLatencyMs) :
+            OutputBuffer(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat),
+            batchRows(batchRows),
+            batchLatencyMs(batchLatencyMs),
+            pendingRows(0),
+            transactionOpen(false),
+            curColumn(nullptr),
+            curRow(0) {
+    }
+
+    OutputBufferArrow::~OutputBufferArrow() {
+        for (auto it : batches) {
+            ArrowBatch *batch = it.second;
+            delete batch;
+        }
+        batches.clear();
+    }
+
+    void OutputBufferArrow::columnNull(OracleColumn *column) {
+        appendNull(curColumn);
+    }
+
+    void OutputBufferArrow::columnFloat(string &columnName, float value) {
+        if (curColumn->type == ARROW_TYPE_FLOAT)
+            appendFixed(curColumn, &value, sizeof(float));
+        else if (curColumn->type == ARROW_TYPE_DOUBLE) {
+            double doubleValue = value;
+            appendFixed(curColumn, &doubleValue, sizeof(double));
+        } else
+            appendNull(curColumn);
+    }
+
+    void OutputBufferArrow::columnDouble(string &columnName, double value) {
+        if (curColumn->type == ARROW_TYPE_DOUBLE)
+            appendFixed(curColumn, &value, sizeof(double));
+        else
+            appendNull(curColumn);
+    }
+
+    //values which can't be represented in the column type (like unknown values) are null
+    void OutputBufferArrow::columnString(string &columnName) {
+        if (curColumn->type == ARROW_TYPE_UTF8)
+            appendVariable(curColumn, (const uint8_t*)valueBuffer, valueLength);
+        else
+            appendNull(curColumn);
+    }
+
+    void OutputBufferArrow::columnNumber(string &columnName, uint64_t precision, uint64_t scale) {
+        if (curColumn->type == ARROW_TYPE_UTF8) {
+            appendVariable(curColumn, (const uint8_t*)valueBuffer, valueLength);
+            return;
+        }
+
+        //integer value which did not fit the fast path
+        if (curColumn->type == ARROW_TYPE_INT64 && valueLength > 0 && valueLength <= 19) {
+            bool negative = (valueBuffer[0] == '-');
+            uint64_t value = 0, i = negative ? 1 : 0;
+            for (; i < valueLength; ++i) {
+                if (valueBuffer[i] < '0' || valueBuffer[i] > '9')
+                    break;
+                value = value * 10 + (valueBuffer[i] - '0');
+            }
+            if (i == valueLength) {
+                int64_t signedValue = negative ? -(int64_t)value : (int64_t)value;
+                appendFixed(curColumn, &signedValue, sizeof(int64_t));
+                return;
+            }
+        }
+        appendNull(curColumn);
+    }
+
+    void OutputBufferArrow::columnInt(string &columnName, uint64_t precision, uint64_t scale, int64_t value) {
+        if (curColumn->type == ARROW_TYPE_INT64)
+            appendFixed(curColumn, &value, sizeof(int64_t));
+        else if (curColumn->type == ARROW_TYPE_UTF8) {
+            char buffer[21];
+            uint64_t absValue = (value < 0) ? -(uint64_t)value : value, length = 21;
+            do {
+                buffer[--length] = '0' + (absValue % 10);
+                absValue /= 10;
+            } while (absValue > 0);
+            if (value < 0)
+                buffer[--length] = '-';
+            appendVariable(curColumn, (const uint8_t*)buffer + length, 21 - length);
+        } else
+            appendNull(curColumn);
+    }
+
+    void OutputBufferArrow::columnRaw(string &columnName, const uint8_t *data, uint64_t length) {
+        if (curColumn->type == ARROW_TYPE_BINARY)
+            appendVariable(curColumn, data, length);
+        else
+            appendNull(curColumn);
+    }
+
+    void OutputBufferArrow::columnTimestamp(string &columnName, struct tm &epochtime, uint64_t fraction, const char *tz) {
+        if (curColumn->type == ARROW_TYPE_TIMESTAMP) {
+            //microseconds since epoch, BC years converted to astronomical numbering
+            int64_t year = (epochtime.tm_year > 0) ? epochtime.tm_year : epochtime.tm_year + 1;
+            int64_t value = (epochDay(year, epochtime.tm_mon, epochtime.tm_mday) * 86400 +
+                    epochtime.tm_hour * 3600 + epochtime.tm_min * 60 + epochtime.tm_sec) * 1000000 + (int64_t)(fraction / 1000);
+            appendFixed(curColumn, &value, sizeof(int64_t));
+        } else if (curColumn->type == ARROW_TYPE_UTF8) {
+            char buffer[80];
+            int length = snprintf(buffer, sizeof(buffer), "%d%s-%02d-%02dT%02d:%02d:%02d",
+                    (epochtime.tm_year > 0) ? epochtime.tm_year : -epochtime.tm_year, (epochtime.tm_year > 0) ? "" : "BC",
+                    epochtime.tm_mon, epochtime.tm_mday, epochtime.tm_hour, epochtime.tm_min, epochtime.tm_sec);
+            if (fraction > 0)
+                length += snprintf(buffer + length, sizeof(buffer) - length, ".%09u", (uint32_t)fraction);
+            if (tz != nullptr)
+                length += snprintf(buffer + length, sizeof(buffer) - length, " %s", tz);
+            if (length >= (int)sizeof(buffer))
+                length = sizeof(buffer) - 1;
+            appendVariable(curColumn, (const uint8_t*)buffer, length);
+        } else
+            appendNull(curColumn);
+    }
+
+    //header fields and row id are columns of the batch, filled in appendRow
+    void OutputBufferArrow::appendRowid(typeobj objn, typeobj objd, typedba bdba, typeslot slot) {
+    }
+
+    void OutputBufferArrow::appendHeader(bool first) {
+    }
+
+    void OutputBufferArrow::appendSchema(OracleObject *object) {
+    }
+
+    void OutputBufferArrow::appendNull(ArrowColumn *column) {
+        if ((curRow & 7) == 0)
+            column->validity.push_back(0);
+        ++column->nullCount;
+
+        if (column->type == ARROW_TYPE_UTF8 || column->type == ARROW_TYPE_BINARY)
+            column->offsets.push_back(column->values.size());
+        else if (column->type == ARROW_TYPE_FLOAT)
+            column->values.resize(column->values.size() + sizeof(float), 0);
+        else
+            column->values.resize(column->values.size() + sizeof(int64_t), 0);
+    }
+
+    void OutputBufferArrow::appendFixed(ArrowColumn *column, const void *data, uint64_t length) {
+        if ((curRow & 7) == 0)
+            column->validity.push_back(0);
+        column->validity.back() |= 1 << (curRow & 7);
+
+        column->values.insert(column->values.end(), (const uint8_t*)data, (const uint8_t*)data + length);
+    }
+
+    void OutputBufferArrow::appendVariable(ArrowColumn *column, const uint8_t *data, uint64_t length) {
+        if ((curRow & 7) == 0)
+            column->validity.push_back(0);
+        column->validity.back() |= 1 << (curRow & 7);
+
+        column->values.insert(column->values.end(), data, data + length);
+        column->offsets.push_back(column->values.size());
+    }
+
+    //insert and update carry the after image, delete the before image; update falls back to before image for columns not in after image
+    void OutputBufferArrow::appendRow(OracleObject *object, typedba bdba, typeslot slot, const char *op, uint64_t type, uint64_t fallback) {
+        ArrowBatch *batch = getBatch(object);
+        if (pendingRows == 0)
+            pendingStart = chrono::steady_clock::now();
+        if (batch->rows == 0)
+            batch->firstScn = lastScn;
+        curRow = batch->rows;
+
+        appendVariable(&batch->columns[0], (const uint8_t*)op, strlen(op));
+        int64_t value = lastScn;
+        appendFixed(&batch->columns[1], &value, sizeof(int64_t));
+        value = lastTime.toTime() * 1000;
+        appendFixed(&batch->columns[2], &value, sizeof(int64_t));
+
+        if (xidFormat == XID_FORMAT_TEXT) {
+            char buffer[24];
+            int length = snprintf(buffer, sizeof(buffer), "%u.%u.%u", (uint32_t)USN(lastXid), (uint32_t)SLT(lastXid), (uint32_t)SQN(lastXid));
+            appendVariable(&batch->columns[3], (const uint8_t*)buffer, length);
+        } else {
+            value = lastXid;
+            appendFixed(&batch->columns[3], &value, sizeof(int64_t));
+        }
+
+        uint32_t afn = bdba >> 22;
+        bdba &= 0x003FFFFF;
+        uint8_t rid[18];
+        rid[0] = map64[(object->objd >> 30) & 0x3F];
+        rid[1] = map64[(object->objd >> 24) & 0x3F];
+        rid[2] = map64[(object->objd >> 18) & 0x3F];
+        rid[3] = map64[(object->objd >> 12) & 0x3F];
+        rid[4] = map64[(object->objd >> 6) & 0x3F];
+        rid[5] = map64[object->objd & 0x3F];
+        rid[6] = map64[(afn >> 12) & 0x3F];
+        rid[7] = map64[(afn >> 6) & 0x3F];
+        rid[8] = map64[afn & 0x3F];
+        rid[9] = map64[(bdba >> 30) & 0x3F];
+        rid[10] = map64[(bdba >> 24) & 0x3F];
+        rid[11] = map64[(bdba >> 18) & 0x3F];
+        rid[12] = map64[(bdba >> 12) & 0x3F];
+        rid[13] = map64[(bdba >> 6) & 0x3F];
+        rid[14] = map64[bdba & 0x3F];
+        rid[15] = map64[(slot >> 12) & 0x3F];
+        rid[16] = map64[(slot >> 6) & 0x3F];
+        rid[17] = map64[slot & 0x3F];
+        appendVariable(&batch->columns[4], rid, 18);
+
+        for (uint64_t j = 5; j < batch->columns.size(); ++j) {
+            ArrowColumn *column = &batch->columns[j];
+            uint16_t i = column->col;
+            const uint8_t *data = nullptr;
+            uint64_t length = 0;
+
+            if (valuesGen[i] == valuesGeneration) {
+                if (valuePresent(i, type)) {
+                    data = values[i][type].data[0];
+                    length = values[i][type].length[0];
+                } else if (valuePresent(i, fallback)) {
+                    data = values[i][fallback].data[0];
+                    length = values[i][fallback].length[0];
+                }
+            }
+
+            if (data != nullptr && length > 0) {
+                curColumn = column;
+                processValue(object->columns[i], data, length);
+            } else
+                appendNull(column);
+        }
+
+        ++batch->rows;
+        ++pendingRows;
+        if (batch->rows >= batchRows)
+            flushBatch(batch);
+    }
+
+    ArrowBatch *OutputBufferArrow::getBatch(OracleObject *object) {
+        auto it = batches.find(object);
+        if (it != batches.end())
+            return (*it).second;
+
+        ArrowBatch *batch = new ArrowBatch;
+        if (batch == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(ArrowBatch) << " bytes memory (for: Arrow batch)");
+        }
+        batch->object = object;
+        batch->rows = 0;
+        batch->firstScn = 0;
+
+        ArrowColumn column;
+        column.nullCount = 0;
+        column.offsets.push_back(0);
+
+        column.col = ARROW_COLUMN_OP;
+        column.type = ARROW_TYPE_UTF8;
+        column.name = "op";
+        batch->columns.push_back(column);
+        column.col = ARROW_COLUMN_SCN;
+        column.type = ARROW_TYPE_INT64;
+        column.name = "scn";
+        batch->columns.push_back(column);
+        column.col = ARROW_COLUMN_TM;
+        column.type = ARROW_TYPE_INT64;
+        column.name = "tm";
+        batch->columns.push_back(column);
+        column.col = ARROW_COLUMN_XID;
+        column.type = (xidFormat == XID_FORMAT_TEXT) ? ARROW_TYPE_UTF8 : ARROW_TYPE_INT64;
+        column.name = "xid";
+        batch->columns.push_back(column);
+        column.col = ARROW_COLUMN_RID;
+        column.type = ARROW_TYPE_UTF8;
+        column.name = "rid";
+        batch->columns.push_back(column);
+
+        for (uint64_t i = 0; i < object->columns.size(); ++i) {
+            OracleColumn *oracleColumn = object->columns[i];
+            if (oracleColumn == nullptr)
+                continue;
+            if (oracleColumn->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
+                continue;
+            if (oracleColumn->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
+                continue;
+
+            column.col = i;
+            column.name = oracleColumn->name;
+            switch (oracleColumn->decodeTypeNo) {
+            case 2: //number
+                if (oracleColumn->scale == 0 && oracleColumn->precision > 0 && oracleColumn->precision <= 18)
+                    column.type = ARROW_TYPE_INT64;
+                else
+                    column.type = ARROW_TYPE_UTF8;
+                break;
+
+            case 12: //date
+            case 180: //timestamp
+                column.type = ARROW_TYPE_TIMESTAMP;
+                break;
+
+            case 23: //raw
+                column.type = ARROW_TYPE_BINARY;
+                break;
+
+            case 100: //binary_float
+                column.type = ARROW_TYPE_FLOAT;
+                break;
+
+            case 101: //binary_double
+                column.type = ARROW_TYPE_DOUBLE;
+                break;
+
+            default:
+                column.type = ARROW_TYPE_UTF8;
+            }
+            batch->columns.push_back(column);
+        }
+
+        buildSchemaMessage(batch);
+        batches[object] = batch;
+        return batch;
+    }
+
+    //one message is a complete IPC stream: schema, record batch and end of stream marker
+    //the message carries the scn up to which all transactions are completely sent, so confirming it never checkpoints past unsent rows
+    void OutputBufferArrow::flushBatch(ArrowBatch *batch) {
+        if (batch->rows == 0)
+            return;
+
+        buildBatchMessage(batch);
+
+        outputBufferBegin(batch->object->objn);
+        curMsg->scn = sentScn(batch);
+        appendMessage(batch->schemaMessage);
+        appendMessage(meta);
+
+        for (ArrowColumn &column : batch->columns) {
+            appendPadded(column.validity.data(), column.validity.size());
+            if (column.type == ARROW_TYPE_UTF8 || column.type == ARROW_TYPE_BINARY)
+                appendPadded((const uint8_t*)column.offsets.data(), column.offsets.size() * sizeof(int32_t));
+            appendPadded(column.values.data(), column.values.size());
+
+            column.nullCount = 0;
+            column.validity.clear();
+            column.values.clear();
+            column.offsets.clear();
+            column.offsets.push_back(0);
+        }
+
+        uint8_t eos[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0};
+        outputBufferAppend(eos, sizeof(eos));
+        outputBufferCommit();
+
+        pendingRows -= batch->rows;
+        batch->rows = 0;
+    }
+
+    void OutputBufferArrow::flushAll(void) {
+        for (auto it : batches)
+            flushBatch(it.second);
+        pendingRows = 0;
+    }
+
+    //transaction with rows still buffered in other batches or not yet processed is sent only up to the previous scn
+    typescn OutputBufferArrow::sentScn(ArrowBatch *flushed) {
+        typescn scn = transactionOpen ? lastScn - 1 : lastScn;
+        for (auto it : batches) {
+            if (it.second != flushed && it.second->rows > 0 && it.second->firstScn - 1 < scn)
+                scn = it.second->firstScn - 1;
+        }
+        return scn;
+    }
+
+    //Message { version: V5, header: Schema { endianness: Little, fields: [Field] }, bodyLength: 0 }
+    void OutputBufferArrow::buildSchemaMessage(ArrowBatch *batch) {
+        vector<uint8_t> &fb = batch->schemaMessage;
+        fb.clear();
+        fb.resize(4, 0);
+
+        uint64_t messageSizes[4] = {2, 1, 4, 8}, messageValues[4] = {4, 1, 0, 0}, messagePos[4];
+        fbPatch(fb, 0, fbTable(fb, messageSizes, messageValues, 4, messagePos));
+
+        uint64_t schemaSizes[2] = {2, 4}, schemaValues[2] = {0, 0}, schemaPos[2];
+        fbPatch(fb, messagePos[2], fbTable(fb, schemaSizes, schemaValues, 2, schemaPos));
+
+        uint64_t fields = fbVector(fb, batch->columns.size(), 4, 4);
+        fbPatch(fb, schemaPos[1], fields);
+
+        for (uint64_t i = 0; i < batch->columns.size(); ++i) {
+            ArrowColumn &column = batch->columns[i];
+            uint64_t typeType, typeCount = 0, typeSizes[2] = {0, 0}, typeValues[2] = {0, 0}, typePos[2];
+
+            switch (column.type) {
+            case ARROW_TYPE_INT64:
+                typeType = 2; //Int { bitWidth: 64, is_signed: true }
+                typeCount = 2;
+                typeSizes[0] = 4;
+                typeValues[0] = 64;
+                typeSizes[1] = 1;
+                typeValues[1] = 1;
+                break;
+
+            case ARROW_TYPE_FLOAT:
+            case ARROW_TYPE_DOUBLE:
+                typeType = 3; //FloatingPoint { precision: SINGLE/DOUBLE }
+                typeCount = 1;
+                typeSizes[0] = 2;
+                typeValues[0] = (column.type == ARROW_TYPE_FLOAT) ? 1 : 2;
+                break;
+
+            case ARROW_TYPE_BINARY:
+                typeType = 4; //Binary
+                break;
+
+            case ARROW_TYPE_TIMESTAMP:
+                typeType = 10; //Timestamp { unit: MICROSECOND }
+                typeCount = 1;
+                typeSizes[0] = 2;
+                typeValues[0] = 2;
+                break;
+
+            default:
+                typeType = 5; //Utf8
+            }
+
+            //Field { name, nullable, type_type, type, dictionary, children }
+            uint64_t fieldSizes[6] = {4, 1, 1, 4, 0, 4}, fieldValues[6] = {0, 1, typeType, 0, 0, 0}, fieldPos[6];
+            fbPatch(fb, fields + 4 + i * 4, fbTable(fb, fieldSizes, fieldValues, 6, fieldPos));
+            fbPatch(fb, fieldPos[0], fbString(fb, column.name));
+            fbPatch(fb, fieldPos[3], fbTable(fb, typeSizes, typeValues, typeCount, typePos));
+            fbPatch(fb, fieldPos[5], fbVector(fb, 0, 4, 4));
+        }
+        fbAlign(fb, 8);
+    }
+
+    //Message { version: V5, header: RecordBatch { length, nodes: [FieldNode], buffers: [Buffer] }, bodyLength }
+    uint64_t OutputBufferArrow::buildBatchMessage(ArrowBatch *batch) {
+        meta.clear();
+        meta.resize(4, 0);
+
+        uint64_t messageSizes[4] = {2, 1, 4, 8}, messageValues[4] = {4, 3, 0, 0}, messagePos[4];
+        fbPatch(meta, 0, fbTable(meta, messageSizes, messageValues, 4, messagePos));
+
+        uint64_t batchSizes[3] = {8, 4, 4}, batchValues[3] = {batch->rows, 0, 0}, batchPos[3];
+        fbPatch(meta, messagePos[2], fbTable(meta, batchSizes, batchValues, 3, batchPos));
+
+        uint64_t nodes = fbVector(meta, batch->columns.size(), 16, 8);
+        fbPatch(meta, batchPos[1], nodes);
+        uint64_t buffersCount = 0;
+        for (uint64_t i = 0; i < batch->columns.size(); ++i) {
+            ArrowColumn &column = batch->columns[i];
+            fbPut(meta, nodes + 4 + i * 16, batch->rows, 8);
+            fbPut(meta, nodes + 4 + i * 16 + 8, column.nullCount, 8);
+            buffersCount += (column.type == ARROW_TYPE_UTF8 || column.type == ARROW_TYPE_BINARY) ? 3 : 2;
+        }
+
+        uint64_t buffers = fbVector(meta, buffersCount, 16, 8);
+        fbPatch(meta, batchPos[2], buffers);
+        uint64_t pos = buffers + 4, bodyLength = 0;
+        for (ArrowColumn &column : batch->columns) {
+            uint64_t lengths[3], count = 0;
+            lengths[count++] = column.validity.size();
+            if (column.type == ARROW_TYPE_UTF8 || column.type == ARROW_TYPE_BINARY)
+                lengths[count++] = column.offsets.size() * sizeof(int32_t);
+            lengths[count++] = column.values.size();
+
+            for (uint64_t j = 0; j < count; ++j) {
+                fbPut(meta, pos, bodyLength, 8);
+                fbPut(meta, pos + 8, lengths[j], 8);
+                pos += 16;
+                bodyLength += (lengths[j] + 7) & 0xFFFFFFFFFFFFFFF8;
+            }
+        }
+
+        fbPut(meta, messagePos[3], bodyLength, 8);
+        fbAlign(meta, 8);
+        return bodyLength;
+    }
+
+    //encapsulated message: continuation marker, metadata length, metadata padded to 8 bytes
+    void OutputBufferArrow::appendMessage(vector<uint8_t> &message) {
+        uint8_t prefix[8] = {0xFF, 0xFF, 0xFF, 0xFF,
+                (uint8_t)(message.size() & 0xFF), (uint8_t)((message.size() >> 8) & 0xFF),
+                (uint8_t)((message.size() >> 16) & 0xFF), (uint8_t)((message.size() >> 24) & 0xFF)};
+        outputBufferAppend(prefix, sizeof(prefix));
+        outputBufferAppend(message.data(), message.size());
+    }
+
+    void OutputBufferArrow::appendPadded(const uint8_t *data, uint64_t length) {
+        static const uint8_t zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        if (length > 0)
+            outputBufferAppend(data, length);
+        if ((length & 7) != 0)
+            outputBufferAppend(zeros, 8 - (length & 7));
+    }
+
+    void OutputBufferArrow::fbAlign(vector<uint8_t> &fb, uint64_t alignment) {
+        while ((fb.size() % alignment) != 0)
+            fb.push_back(0);
+    }
+
+    void OutputBufferArrow::fbPut(vector<uint8_t> &fb, uint64_t pos, uint64_t value, uint64_t size) {
+        for (uint64_t i = 0; i < size; ++i)
+            fb[pos + i] = (value >> (i * 8)) & 0xFF;
+    }
+
+    //offsets always point forward, children are written after their parent
+    void OutputBufferArrow::fbPatch(vector<uint8_t> &fb, uint64_t pos, uint64_t target) {
+        fbPut(fb, pos, target - pos, 4);
+    }
+
+    //flatbuffer table preceded by its vtable, fields of size 0 are absent, up to 8 fields
+    uint64_t OutputBufferArrow::fbTable(vector<uint8_t> &fb, const uint64_t *sizes, const uint64_t *values, uint64_t count, uint64_t *positions) {
+        uint64_t offsets[8], tableSize = 4;
+        for (uint64_t size = 8; size > 0; size >>= 1) {
+            for (uint64_t i = 0; i < count; ++i) {
+                if (sizes[i] != size)
+                    continue;
+                tableSize = (tableSize + size - 1) & ~(size - 1);
+                offsets[i] = tableSize;
+                tableSize += size;
+            }
+        }
+
+        fbAlign(fb, 2);
+        uint64_t vtable = fb.size();
+        fb.resize(vtable + 4 + count * 2, 0);
+        fbPut(fb, vtable, 4 + count * 2, 2);
+        fbPut(fb, vtable + 2, tableSize, 2);
+        for (uint64_t i = 0; i < count; ++i)
+            fbPut(fb, vtable + 4 + i * 2, (sizes[i] > 0) ? offsets[i] : 0, 2);
+
+        fbAlign(fb, 8);
+        uint64_t table = fb.size();
+        fb.resize(table + tableSize, 0);
+        fbPut(fb, table, table - vtable, 4);
+        for (uint64_t i = 0; i < count; ++i) {
+            if (sizes[i] == 0)
+                continue;
+            positions[i] = table + offsets[i];
+            fbPut(fb, positions[i], values[i], sizes[i]);
+        }
+        return table;
+    }
+
+    uint64_t OutputBufferArrow::fbVector(vector<uint8_t> &fb, uint64_t count, uint64_t elementSize, uint64_t alignment) {
+        fbAlign(fb, 4);
+        while (((fb.size() + 4) % alignment) != 0)
+            fb.push_back(0);
+        uint64_t vector = fb.size();
+        fb.resize(vector + 4 + count * elementSize, 0);
+        fbPut(fb, vector, count, 4);
+        return vector;
+    }
+
+    uint64_t OutputBufferArrow::fbString(vector<uint8_t> &fb, const string &str) {
+        fbAlign(fb, 4);
+        uint64_t pos = fb.size();
+        fb.resize(pos + 4, 0);
+        fbPut(fb, pos, str.length(), 4);
+        fb.insert(fb.end(), str.begin(), str.end());
+        fb.push_back(0);
+        return pos;
+    }
+
+    OutputBuffer *OutputBufferArrow::newFormatter(void) {
+        RUNTIME_FAIL("formatter threads are not supported for \"arrow\" format");
+    }
+
+    void OutputBufferArrow::processBegin(typescn scn, typetime time, typexid xid) {
+        lastTime = time;
+        lastScn = scn;
+        lastXid = xid;
+        transactionOpen = true;
+    }
+
+    void OutputBufferArrow::processCommit(void) {
+        transactionOpen = false;
+        if (pendingRows == 0)
+            return;
+
+        if (pendingRows >= batchRows ||
+                chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - pendingStart).count() >= (int64_t)batchLatencyMs)
+            flushAll();
+    }
+
+    void OutputBufferArrow::processRollback(typescn scn, typetime time, typexid xid) {
+        RUNTIME_FAIL("ERROR, Arrow rollback marker is not supported, streaming of transactions requires JSON format");
+    }
+
+    void OutputBufferArrow::processInsert(OracleObject *object, typedba bdba, typeslot slot, typexid xid) {
+        appendRow(object, bdba, slot, "c", VALUE_AFTER, VALUE_AFTER);
+    }
+
+    void OutputBufferArrow::processUpdate(OracleObject *object, typedba bdba, typeslot slot, typexid xid) {
+        appendRow(object, bdba, slot, "u", VALUE_AFTER, VALUE_BEFORE);
+    }
+
+    void OutputBufferArrow::processDelete(OracleObject *object, typedba bdba, typeslot slot, typexid xid) {
+        appendRow(object, bdba, slot, "d", VALUE_BEFORE, VALUE_BEFORE);
+    }
+
+    //DDL is not part of the columnar output, rows collected before it are sent
+    void OutputBufferArrow::processDDL(OracleObject *object, uint16_t type, uint16_t seq, const char *operation, const char *sql, uint64_t sqlLength) {
+        auto it = batches.find(object);
+        if (it != batches.end() && (*it).second->rows > 0)
+            flushBatch((*it).second);
+    }
+
+    //rows are not held longer than batch-latency-ms when no further transactions commit
+    void OutputBufferArrow::processPoll(void) {
+        if (pendingRows > 0 &&
+                chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - pendingStart).count() >= (int64_t)batchLatencyMs)
+            flushAll();
+    }
+}
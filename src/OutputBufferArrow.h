@@ -0,0 +1,126 @@
+/* Header for OutputBufferArrow class
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <chrono>
+#include <vector>
+
+#include "OutputBuffer.h"
+
+#ifndef OUTPUTBUFFERARROW_H_
+#define OUTPUTBUFFERARROW_H_
+
+#define ARROW_TYPE_UTF8                         0
+#define ARROW_TYPE_INT64                        1
+#define ARROW_TYPE_FLOAT                        2
+#define ARROW_TYPE_DOUBLE                       3
+#define ARROW_TYPE_BINARY                       4
+#define ARROW_TYPE_TIMESTAMP                    5
+
+#define ARROW_COLUMN_OP                         0xFFFF
+#define ARROW_COLUMN_SCN                        0xFFFE
+#define ARROW_COLUMN_TM                         0xFFFD
+#define ARROW_COLUMN_XID                        0xFFFC
+#define ARROW_COLUMN_RID                        0xFFFB
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    //one column of a record batch under construction
+    struct ArrowColumn {
+        uint16_t col;
+        uint64_t type;
+        string name;
+        uint64_t nullCount;
+        vector<uint8_t> validity;
+        vector<uint8_t> values;
+        vector<int32_t> offsets;
+    };
+
+    //rows of one table waiting to be sent
+    struct ArrowBatch {
+        OracleObject *object;
+        uint64_t rows;
+        typescn firstScn;                           //scn of the oldest row in the batch
+        vector<ArrowColumn> columns;
+        vector<uint8_t> schemaMessage;
+    };
+
+    class OutputBufferArrow : public OutputBuffer {
+    protected:
+        uint64_t batchRows;
+        uint64_t batchLatencyMs;
+        unordered_map<OracleObject*, ArrowBatch*> batches;
+        uint64_t pendingRows;
+        bool transactionOpen;                       //rows of the last transaction may still follow
+        chrono::steady_clock::time_point pendingStart;
+        ArrowColumn *curColumn;
+        uint64_t curRow;
+        vector<uint8_t> meta;
+
+        virtual void columnNull(OracleColumn *column);
+        virtual void columnFloat(string &columnName, float value);
+        virtual void columnDouble(string &columnName, double value);
+        virtual void columnString(string &columnName);
+        virtual void columnNumber(string &columnName, uint64_t precision, uint64_t scale);
+        virtual void columnInt(string &columnName, uint64_t precision, uint64_t scale, int64_t value);
+        virtual void columnRaw(string &columnName, const uint8_t *data, uint64_t length);
+        virtual void columnTimestamp(string &columnName, struct tm &epochtime, uint64_t fraction, const char *tz);
+        virtual void appendRowid(typeobj objn, typeobj objd, typedba bdba, typeslot slot);
+        virtual void appendHeader(bool first);
+        virtual void appendSchema(OracleObject *object);
+
+        void appendNull(ArrowColumn *column);
+        void appendFixed(ArrowColumn *column, const void *data, uint64_t length);
+        void appendVariable(ArrowColumn *column, const uint8_t *data, uint64_t length);
+        void appendRow(OracleObject *object, typedba bdba, typeslot slot, const char *op, uint64_t type, uint64_t fallback);
+        ArrowBatch *getBatch(OracleObject *object);
+        void flushBatch(ArrowBatch *batch);
+        void flushAll(void);
+        typescn sentScn(ArrowBatch *flushed);
+        void buildSchemaMessage(ArrowBatch *batch);
+        uint64_t buildBatchMessage(ArrowBatch *batch);
+        void appendMessage(vector<uint8_t> &message);
+        void appendPadded(const uint8_t *data, uint64_t length);
+
+        static void fbAlign(vector<uint8_t> &fb, uint64_t alignment);
+        static void fbPut(vector<uint8_t> &fb, uint64_t pos, uint64_t value, uint64_t size);
+        static void fbPatch(vector<uint8_t> &fb, uint64_t pos, uint64_t target);
+        static uint64_t fbTable(vector<uint8_t> &fb, const uint64_t *sizes, const uint64_t *values, uint64_t count, uint64_t *positions);
+        static uint64_t fbVector(vector<uint8_t> &fb, uint64_t count, uint64_t elementSize, uint64_t alignment);
+        static uint64_t fbString(vector<uint8_t> &fb, const string &str);
+
+    public:
+        OutputBufferArrow(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
+                uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat, uint64_t batchRows, uint64_t batchLatencyMs);
+        virtual ~OutputBufferArrow();
+
+        virtual OutputBuffer *newFormatter(void);
+        virtual void processBegin(typescn scn, typetime time, typexid xid);
+        virtual void processCommit(void);
+        virtual void processRollback(typescn scn, typetime time, typexid xid);
+        virtual void processInsert(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
+        virtual void processUpdate(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
+        virtual void processDelete(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
+        virtual void processDDL(OracleObject *object, uint16_t type, uint16_t seq, const char *operation, const char *sql, uint64_t sqlLength);
+        virtual void processPoll(void);
+    };
+}
+
+#endif
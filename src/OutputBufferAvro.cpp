@@ -0,0 +1,600 @@
+/* Memory buffer for handling output data in Avro format
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <fstream>
+#include <set>
+#include <string.h>
+
+#include "OracleAnalyzer.h"
+#include "OracleColumn.h"
+#include "OracleObject.h"
+#include "OutputBufferAvro.h"
+#include "RuntimeException.h"
+
+namespace OpenLogReplicator {
+
+    AvroRegistry::AvroRegistry(const char *schemaPath) :
+            schemaPath(schemaPath),
+            controlFingerprint(0) {
+
+        //CRC-64-AVRO (Rabin) used for schema fingerprints
+        for (uint64_t i = 0; i < 256; ++i) {
+            uint64_t fp = i;
+            for (uint64_t j = 0; j < 8; ++j)
+                fp = (fp >> 1) ^ (0xC15D213AA4D7A795 & -(fp & 1));
+            fingerprintTable[i] = fp;
+        }
+    }
+
+    AvroRegistry::~AvroRegistry() {
+        for (auto it : schemas) {
+            AvroSchema *schema = it.second;
+            delete schema;
+        }
+        schemas.clear();
+    }
+
+    uint64_t AvroRegistry::fingerprint(string &canonical) {
+        uint64_t fp = 0xC15D213AA4D7A795;
+        for (uint64_t i = 0; i < canonical.length(); ++i)
+            fp = (fp >> 8) ^ fingerprintTable[(fp ^ (uint8_t)canonical[i]) & 0xFF];
+        return fp;
+    }
+
+    //schema store: one <fingerprint>.avsc file per schema
+    void AvroRegistry::writeSchema(uint64_t fingerprint, string &full) {
+        char name[17];
+        for (uint64_t i = 0; i < 16; ++i)
+            name[i] = "0123456789ABCDEF"[(fingerprint >> ((15 - i) * 4)) & 0xF];
+        name[16] = 0;
+
+        string fileName = schemaPath + "/" + name + ".avsc";
+        ofstream outfile;
+        outfile.open(fileName.c_str(), ios::out | ios::trunc);
+
+        if (!outfile.is_open()) {
+            RUNTIME_FAIL("writing Avro schema to " << fileName);
+        }
+        outfile << full;
+        outfile.close();
+    }
+
+    OutputBufferAvro::OutputBufferAvro(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
+            uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat, const char *schemaPath) :
+            OutputBuffer(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat),
+            registry(nullptr),
+            registryOwner(true),
+            columnType(AVRO_TYPE_STRING) {
+
+        registry = new AvroRegistry(schemaPath);
+        if (registry == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(AvroRegistry) << " bytes memory (for: Avro schema registry)");
+        }
+
+        string canonical, full;
+        buildControlSchema(canonical, full);
+        registry->controlFingerprint = registry->fingerprint(canonical);
+        registry->writeSchema(registry->controlFingerprint, full);
+    }
+
+    OutputBufferAvro::OutputBufferAvro(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
+            uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat, AvroRegistry *registry) :
+            OutputBuffer(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat),
+            registry(registry),
+            registryOwner(false),
+            columnType(AVRO_TYPE_STRING) {
+    }
+
+    OutputBufferAvro::~OutputBufferAvro() {
+        localSchemas.clear();
+        if (registryOwner && registry != nullptr) {
+            delete registry;
+            registry = nullptr;
+        }
+    }
+
+    void OutputBufferAvro::columnNull(OracleColumn *column) {
+        appendLong(0);
+    }
+
+    void OutputBufferAvro::columnFloat(string &columnName, float value) {
+        if (columnType == AVRO_TYPE_FLOAT) {
+            appendLong(1);
+            outputBufferAppend((const uint8_t*)&value, sizeof(float));
+        } else if (columnType == AVRO_TYPE_DOUBLE) {
+            double doubleValue = value;
+            appendLong(1);
+            outputBufferAppend((const uint8_t*)&doubleValue, sizeof(double));
+        } else
+            appendLong(0);
+    }
+
+    void OutputBufferAvro::columnDouble(string &columnName, double value) {
+        if (columnType == AVRO_TYPE_DOUBLE) {
+            appendLong(1);
+            outputBufferAppend((const uint8_t*)&value, sizeof(double));
+        } else
+            appendLong(0);
+    }
+
+    //values which can't be represented in the field type (like unknown values) are sent as null
+    void OutputBufferAvro::columnString(string &columnName) {
+        if (columnType == AVRO_TYPE_STRING) {
+            appendLong(1);
+            appendBytes((const uint8_t*)valueBuffer, valueLength);
+        } else
+            appendLong(0);
+    }
+
+    void OutputBufferAvro::columnNumber(string &columnName, uint64_t precision, uint64_t scale) {
+        if (columnType == AVRO_TYPE_STRING) {
+            appendLong(1);
+            appendBytes((const uint8_t*)valueBuffer, valueLength);
+            return;
+        }
+
+        //integer value which did not fit the fast path
+        if (columnType == AVRO_TYPE_LONG && valueLength > 0 && valueLength <= 19) {
+            bool negative = (valueBuffer[0] == '-');
+            uint64_t value = 0, i = negative ? 1 : 0;
+            for (; i < valueLength; ++i) {
+                if (valueBuffer[i] < '0' || valueBuffer[i] > '9')
+                    break;
+                value = value * 10 + (valueBuffer[i] - '0');
+            }
+            if (i == valueLength) {
+                appendLong(1);
+                appendLong(negative ? -(int64_t)value : (int64_t)value);
+                return;
+            }
+        }
+        appendLong(0);
+    }
+
+    void OutputBufferAvro::columnInt(string &columnName, uint64_t precision, uint64_t scale, int64_t value) {
+        if (columnType == AVRO_TYPE_LONG) {
+            appendLong(1);
+            appendLong(value);
+        } else if (columnType == AVRO_TYPE_STRING) {
+            char buffer[21];
+            uint64_t absValue = (value < 0) ? -(uint64_t)value : value, length = 21;
+            do {
+                buffer[--length] = '0' + (absValue % 10);
+                absValue /= 10;
+            } while (absValue > 0);
+            if (value < 0)
+                buffer[--length] = '-';
+
+            appendLong(1);
+            appendBytes((const uint8_t*)buffer + length, 21 - length);
+        } else
+            appendLong(0);
+    }
+
+    void OutputBufferAvro::columnRaw(string &columnName, const uint8_t *data, uint64_t length) {
+        if (columnType == AVRO_TYPE_BYTES) {
+            appendLong(1);
+            appendBytes(data, length);
+        } else
+            appendLong(0);
+    }
+
+    void OutputBufferAvro::columnTimestamp(string &columnName, struct tm &epochtime, uint64_t fraction, const char *tz) {
+        if (columnType == AVRO_TYPE_TIMESTAMP) {
+            //timestamp-micros, BC years converted to astronomical numbering
+            int64_t year = (epochtime.tm_year > 0) ? epochtime.tm_year : epochtime.tm_year + 1;
+            int64_t seconds = epochDay(year, epochtime.tm_mon, epochtime.tm_mday) * 86400 +
+                    epochtime.tm_hour * 3600 + epochtime.tm_min * 60 + epochtime.tm_sec;
+            appendLong(1);
+            appendLong(seconds * 1000000 + (int64_t)(fraction / 1000));
+        } else if (columnType == AVRO_TYPE_STRING) {
+            char buffer[80];
+            int length = snprintf(buffer, sizeof(buffer), "%d%s-%02d-%02dT%02d:%02d:%02d",
+                    (epochtime.tm_year > 0) ? epochtime.tm_year : -epochtime.tm_year, (epochtime.tm_year > 0) ? "" : "BC",
+                    epochtime.tm_mon, epochtime.tm_mday, epochtime.tm_hour, epochtime.tm_min, epochtime.tm_sec);
+            if (fraction > 0)
+                length += snprintf(buffer + length, sizeof(buffer) - length, ".%09u", (uint32_t)fraction);
+            if (tz != nullptr)
+                length += snprintf(buffer + length, sizeof(buffer) - length, " %s", tz);
+            if (length >= (int)sizeof(buffer))
+                length = sizeof(buffer) - 1;
+
+            appendLong(1);
+            appendBytes((const uint8_t*)buffer, length);
+        } else
+            appendLong(0);
+    }
+
+    void OutputBufferAvro::appendRowid(typeobj objn, typeobj objd, typedba bdba, typeslot slot) {
+        uint32_t afn = bdba >> 22;
+        bdba &= 0x003FFFFF;
+
+        uint8_t rid[18];
+        rid[0] = map64[(objd >> 30) & 0x3F];
+        rid[1] = map64[(objd >> 24) & 0x3F];
+        rid[2] = map64[(objd >> 18) & 0x3F];
+        rid[3] = map64[(objd >> 12) & 0x3F];
+        rid[4] = map64[(objd >> 6) & 0x3F];
+        rid[5] = map64[objd & 0x3F];
+        rid[6] = map64[(afn >> 12) & 0x3F];
+        rid[7] = map64[(afn >> 6) & 0x3F];
+        rid[8] = map64[afn & 0x3F];
+        rid[9] = map64[(bdba >> 30) & 0x3F];
+        rid[10] = map64[(bdba >> 24) & 0x3F];
+        rid[11] = map64[(bdba >> 18) & 0x3F];
+        rid[12] = map64[(bdba >> 12) & 0x3F];
+        rid[13] = map64[(bdba >> 6) & 0x3F];
+        rid[14] = map64[bdba & 0x3F];
+        rid[15] = map64[(slot >> 12) & 0x3F];
+        rid[16] = map64[(slot >> 6) & 0x3F];
+        rid[17] = map64[slot & 0x3F];
+        appendBytes(rid, 18);
+    }
+
+    //scn, tm, xid fields common to all records
+    void OutputBufferAvro::appendHeader(bool first) {
+        appendLong(lastScn);
+        appendLong(lastTime.toTime() * 1000);
+
+        if (xidFormat == XID_FORMAT_TEXT) {
+            char buffer[24];
+            int length = snprintf(buffer, sizeof(buffer), "%u.%u.%u", (uint32_t)USN(lastXid), (uint32_t)SLT(lastXid), (uint32_t)SQN(lastXid));
+            appendBytes((const uint8_t*)buffer, length);
+        } else
+            appendLong(lastXid);
+    }
+
+    //owner and table fields of control record
+    void OutputBufferAvro::appendSchema(OracleObject *object) {
+        if (object == nullptr) {
+            appendLong(0);
+            appendLong(0);
+            return;
+        }
+
+        appendLong(1);
+        appendBytes((const uint8_t*)object->owner.c_str(), object->owner.length());
+        appendLong(1);
+        appendBytes((const uint8_t*)object->name.c_str(), object->name.length());
+    }
+
+    //zig-zag varint used for Avro int, long, enum and union index
+    void OutputBufferAvro::appendLong(int64_t value) {
+        uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+        uint8_t *buffer = outputBufferReserve(10);
+        uint64_t length = 0;
+
+        while (zigzag >= 0x80) {
+            buffer[length++] = (zigzag & 0x7F) | 0x80;
+            zigzag >>= 7;
+        }
+        buffer[length++] = zigzag;
+        outputBufferReserveCommit(length);
+    }
+
+    void OutputBufferAvro::appendBytes(const uint8_t *data, uint64_t length) {
+        appendLong(length);
+        outputBufferAppend(data, length);
+    }
+
+    //single object encoding: C3 01 marker and little-endian schema fingerprint
+    void OutputBufferAvro::appendFingerprint(uint64_t fingerprint) {
+        uint8_t *buffer = outputBufferReserve(10);
+        buffer[0] = 0xC3;
+        buffer[1] = 0x01;
+        for (uint64_t i = 0; i < 8; ++i)
+            buffer[i + 2] = (fingerprint >> (i * 8)) & 0xFF;
+        outputBufferReserveCommit(10);
+    }
+
+    void OutputBufferAvro::appendControl(uint64_t op) {
+        appendFingerprint(registry->controlFingerprint);
+        appendHeader(true);
+        appendLong(op);
+    }
+
+    //all schema fields in order; columns not in the image are taken from the fallback image (update: unchanged columns), otherwise null
+    void OutputBufferAvro::appendRow(OracleObject *object, AvroSchema *schema, uint64_t type, uint64_t fallback) {
+        for (uint64_t j = 0; j < schema->columns.size(); ++j) {
+            uint16_t i = schema->columns[j];
+            const uint8_t *data = nullptr;
+            uint64_t length = 0;
+
+            if (valuesGen[i] == valuesGeneration) {
+                if (valuePresent(i, type)) {
+                    data = values[i][type].data[0];
+                    length = values[i][type].length[0];
+                } else if (valuePresent(i, fallback)) {
+                    data = values[i][fallback].data[0];
+                    length = values[i][fallback].length[0];
+                }
+            }
+
+            if (data != nullptr && length > 0) {
+                columnType = schema->types[j];
+                processValue(object->columns[i], data, length);
+            } else
+                appendLong(0);
+        }
+    }
+
+    AvroSchema *OutputBufferAvro::getSchema(OracleObject *object) {
+        auto it = localSchemas.find(object);
+        if (it != localSchemas.end())
+            return (*it).second;
+
+        AvroSchema *schema = nullptr;
+        {
+            unique_lock<mutex> lck(registry->mtx);
+            auto it2 = registry->schemas.find(object);
+            if (it2 != registry->schemas.end())
+                schema = (*it2).second;
+            else {
+                schema = new AvroSchema;
+                if (schema == nullptr) {
+                    RUNTIME_FAIL("couldn't allocate " << dec << sizeof(AvroSchema) << " bytes memory (for: Avro schema)");
+                }
+
+                string canonical, full;
+                buildSchema(object, schema, canonical, full);
+                schema->fingerprint = registry->fingerprint(canonical);
+                registry->schemas[object] = schema;
+                registry->writeSchema(schema->fingerprint, full);
+            }
+        }
+
+        localSchemas[object] = schema;
+        return schema;
+    }
+
+    //Avro names allow only [A-Za-z_][A-Za-z0-9_]*
+    void OutputBufferAvro::appendName(string &str, const string &name) {
+        for (uint64_t i = 0; i < name.length(); ++i) {
+            char c = name[i];
+            if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' || (i > 0 && c >= '0' && c <= '9'))
+                str.push_back(c);
+            else
+                str.push_back('_');
+        }
+        if (name.length() == 0)
+            str.push_back('_');
+    }
+
+    //canonical form is used for the fingerprint, full form (with logical types) goes to the schema store
+    void OutputBufferAvro::buildSchema(OracleObject *object, AvroSchema *schema, string &canonical, string &full) {
+        string name("OpenLogReplicator.");
+        appendName(name, object->owner);
+        name.push_back('.');
+        appendName(name, object->name);
+
+        string fieldsCanonical, fieldsFull;
+        set<string> fieldNames;
+        for (uint64_t i = 0; i < object->columns.size(); ++i) {
+            OracleColumn *column = object->columns[i];
+            if (column == nullptr)
+                continue;
+            if (column->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
+                continue;
+            if (column->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
+                continue;
+
+            uint64_t type;
+            const char *typeCanonical, *typeFull;
+            switch (column->decodeTypeNo) {
+            case 2: //number
+                if (column->scale == 0 && column->precision > 0 && column->precision <= 18) {
+                    type = AVRO_TYPE_LONG;
+                    typeCanonical = typeFull = "\"long\"";
+                } else {
+                    type = AVRO_TYPE_STRING;
+                    typeCanonical = typeFull = "\"string\"";
+                }
+                break;
+
+            case 12: //date
+            case 180: //timestamp
+                type = AVRO_TYPE_TIMESTAMP;
+                typeCanonical = "\"long\"";
+                typeFull = "{\"type\":\"long\",\"logicalType\":\"timestamp-micros\"}";
+                break;
+
+            case 23: //raw
+                type = AVRO_TYPE_BYTES;
+                typeCanonical = typeFull = "\"bytes\"";
+                break;
+
+            case 100: //binary_float
+                type = AVRO_TYPE_FLOAT;
+                typeCanonical = typeFull = "\"float\"";
+                break;
+
+            case 101: //binary_double
+                type = AVRO_TYPE_DOUBLE;
+                typeCanonical = typeFull = "\"double\"";
+                break;
+
+            default:
+                type = AVRO_TYPE_STRING;
+                typeCanonical = typeFull = "\"string\"";
+            }
+
+            schema->columns.push_back(i);
+            schema->types.push_back(type);
+
+            //columns differing only in characters not allowed in Avro names get a numeric suffix
+            string fieldName;
+            appendName(fieldName, column->name);
+            if (!fieldNames.insert(fieldName).second) {
+                uint64_t suffix = 2;
+                while (!fieldNames.insert(fieldName + "_" + to_string(suffix)).second)
+                    ++suffix;
+                WARNING("table " << object->owner << "." << object->name << " column " << column->name << " written to Avro as " <<
+                        fieldName << "_" << suffix);
+                fieldName += "_" + to_string(suffix);
+            }
+
+            string field("{\"name\":\"");
+            field.append(fieldName);
+            field.append("\",\"type\":[\"null\",");
+
+            if (fieldsCanonical.length() > 0) {
+                fieldsCanonical.push_back(',');
+                fieldsFull.push_back(',');
+            }
+            fieldsCanonical.append(field).append(typeCanonical).append("]}");
+            fieldsFull.append(field).append(typeFull).append("]}");
+        }
+
+        const char *xidType = (xidFormat == XID_FORMAT_TEXT) ? "\"string\"" : "\"long\"";
+        string head = "{\"name\":\"" + name + "\",\"type\":\"record\",\"fields\":[{\"name\":\"scn\",\"type\":\"long\"},"
+                "{\"name\":\"tm\",\"type\":\"long\"},{\"name\":\"xid\",\"type\":" + xidType + "},"
+                "{\"name\":\"op\",\"type\":{\"name\":\"" + name + "_op\",\"type\":\"enum\",\"symbols\":[\"c\",\"u\",\"d\"]}},"
+                "{\"name\":\"rid\",\"type\":\"string\"},"
+                "{\"name\":\"before\",\"type\":[\"null\",{\"name\":\"" + name + "_row\",\"type\":\"record\",\"fields\":[";
+        string tail = "]}]},{\"name\":\"after\",\"type\":[\"null\",\"" + name + "_row\"]}]}";
+
+        canonical = head + fieldsCanonical + tail;
+        full = head + fieldsFull + tail;
+    }
+
+    void OutputBufferAvro::buildControlSchema(string &canonical, string &full) {
+        const char *xidType = (xidFormat == XID_FORMAT_TEXT) ? "\"string\"" : "\"long\"";
+        canonical = string("{\"name\":\"OpenLogReplicator.control\",\"type\":\"record\",\"fields\":[{\"name\":\"scn\",\"type\":\"long\"},"
+                "{\"name\":\"tm\",\"type\":\"long\"},{\"name\":\"xid\",\"type\":") + xidType + "},"
+                "{\"name\":\"op\",\"type\":{\"name\":\"OpenLogReplicator.op\",\"type\":\"enum\",\"symbols\":[\"begin\",\"commit\",\"rollback\",\"ddl\"]}},"
+                "{\"name\":\"owner\",\"type\":[\"null\",\"string\"]},{\"name\":\"table\",\"type\":[\"null\",\"string\"]},"
+                "{\"name\":\"sql\",\"type\":[\"null\",\"string\"]}]}";
+        full = canonical;
+    }
+
+    OutputBuffer *OutputBufferAvro::newFormatter(void) {
+        OutputBuffer *formatter = new OutputBufferAvro(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat, registry);
+        if (formatter == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OutputBufferAvro) << " bytes memory (for: formatter)");
+        }
+        return formatter;
+    }
+
+    void OutputBufferAvro::processBegin(typescn scn, typetime time, typexid xid) {
+        lastTime = time;
+        lastScn = scn;
+        lastXid = xid;
+
+        outputBufferBegin(0);
+        appendControl(AVRO_OP_BEGIN);
+        appendSchema(nullptr);
+        appendLong(0);
+
+        if (messageFormat == MESSAGE_FORMAT_SHORT)
+            outputBufferCommit();
+    }
+
+    void OutputBufferAvro::processCommit(void) {
+        if (messageFormat == MESSAGE_FORMAT_SHORT)
+            outputBufferBegin(0);
+
+        appendControl(AVRO_OP_COMMIT);
+        appendSchema(nullptr);
+        appendLong(0);
+        outputBufferCommit();
+    }
+
+    void OutputBufferAvro::processRollback(typescn scn, typetime time, typexid xid) {
+        lastTime = time;
+        lastScn = scn;
+        lastXid = xid;
+
+        outputBufferBegin(0);
+        appendControl(AVRO_OP_ROLLBACK);
+        appendSchema(nullptr);
+        appendLong(0);
+        outputBufferCommit();
+    }
+
+    void OutputBufferAvro::processInsert(OracleObject *object, typedba bdba, typeslot slot, typexid xid) {
+        AvroSchema *schema = getSchema(object);
+        if (messageFormat == MESSAGE_FORMAT_SHORT) {
+            outputBufferBegin(object->objn);
+            outputBufferKey(object, bdba, slot, VALUE_AFTER, VALUE_BEFORE);
+        }
+
+        appendFingerprint(schema->fingerprint);
+        appendHeader(false);
+        appendLong(AVRO_OP_INSERT);
+        appendRowid(object->objn, object->objd, bdba, slot);
+        appendLong(0);
+        appendLong(1);
+        appendRow(object, schema, VALUE_AFTER, VALUE_AFTER);
+
+        if (messageFormat == MESSAGE_FORMAT_SHORT)
+            outputBufferCommit();
+    }
+
+    void OutputBufferAvro::processUpdate(OracleObject *object, typedba bdba, typeslot slot, typexid xid) {
+        AvroSchema *schema = getSchema(object);
+        if (messageFormat == MESSAGE_FORMAT_SHORT) {
+            outputBufferBegin(object->objn);
+            outputBufferKey(object, bdba, slot, VALUE_AFTER, VALUE_BEFORE);
+        }
+
+        appendFingerprint(schema->fingerprint);
+        appendHeader(false);
+        appendLong(AVRO_OP_UPDATE);
+        appendRowid(object->objn, object->objd, bdba, slot);
+        appendLong(1);
+        appendRow(object, schema, VALUE_BEFORE, VALUE_BEFORE);
+        appendLong(1);
+        appendRow(object, schema, VALUE_AFTER, VALUE_BEFORE);
+
+        if (messageFormat == MESSAGE_FORMAT_SHORT)
+            outputBufferCommit();
+    }
+
+    void OutputBufferAvro::processDelete(OracleObject *object, typedba bdba, typeslot slot, typexid xid) {
+        AvroSchema *schema = getSchema(object);
+        if (messageFormat == MESSAGE_FORMAT_SHORT) {
+            outputBufferBegin(object->objn);
+            outputBufferKey(object, bdba, slot, VALUE_BEFORE, VALUE_AFTER);
+        }
+
+        appendFingerprint(schema->fingerprint);
+        appendHeader(false);
+        appendLong(AVRO_OP_DELETE);
+        appendRowid(object->objn, object->objd, bdba, slot);
+        appendLong(1);
+        appendRow(object, schema, VALUE_BEFORE, VALUE_BEFORE);
+        appendLong(0);
+
+        if (messageFormat == MESSAGE_FORMAT_SHORT)
+            outputBufferCommit();
+    }
+
+    void OutputBufferAvro::processDDL(OracleObject *object, uint16_t type, uint16_t seq, const char *operation, const char *sql, uint64_t sqlLength) {
+        if (messageFormat == MESSAGE_FORMAT_SHORT)
+            outputBufferBegin(object->objn);
+
+        appendControl(AVRO_OP_DDL);
+        appendSchema(object);
+        appendLong(1);
+        appendBytes((const uint8_t*)sql, sqlLength);
+
+        if (messageFormat == MESSAGE_FORMAT_SHORT)
+            outputBufferCommit();
+    }
+}
@@ -0,0 +1,118 @@
+/* Header for OutputBufferAvro class
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <vector>
+
+#include "OutputBuffer.h"
+
+#ifndef OUTPUTBUFFERAVRO_H_
+#define OUTPUTBUFFERAVRO_H_
+
+#define AVRO_TYPE_STRING                        0
+#define AVRO_TYPE_LONG                          1
+#define AVRO_TYPE_FLOAT                         2
+#define AVRO_TYPE_DOUBLE                        3
+#define AVRO_TYPE_BYTES                         4
+#define AVRO_TYPE_TIMESTAMP                     5
+
+#define AVRO_OP_BEGIN                           0
+#define AVRO_OP_COMMIT                          1
+#define AVRO_OP_ROLLBACK                        2
+#define AVRO_OP_DDL                             3
+
+#define AVRO_OP_INSERT                          0
+#define AVRO_OP_UPDATE                          1
+#define AVRO_OP_DELETE                          2
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    //record schema of one table, columns in field order
+    struct AvroSchema {
+        uint64_t fingerprint;
+        vector<uint16_t> columns;
+        vector<uint64_t> types;
+    };
+
+    //schemas shared by the output buffer and its formatters
+    class AvroRegistry {
+    public:
+        mutex mtx;
+        string schemaPath;
+        uint64_t fingerprintTable[256];
+        uint64_t controlFingerprint;
+        unordered_map<OracleObject*, AvroSchema*> schemas;
+
+        uint64_t fingerprint(string &canonical);
+        void writeSchema(uint64_t fingerprint, string &full);
+
+        AvroRegistry(const char *schemaPath);
+        virtual ~AvroRegistry();
+    };
+
+    class OutputBufferAvro : public OutputBuffer {
+    protected:
+        AvroRegistry *registry;
+        bool registryOwner;
+        unordered_map<OracleObject*, AvroSchema*> localSchemas;
+        uint64_t columnType;
+
+        virtual void columnNull(OracleColumn *column);
+        virtual void columnFloat(string &columnName, float value);
+        virtual void columnDouble(string &columnName, double value);
+        virtual void columnString(string &columnName);
+        virtual void columnNumber(string &columnName, uint64_t precision, uint64_t scale);
+        virtual void columnInt(string &columnName, uint64_t precision, uint64_t scale, int64_t value);
+        virtual void columnRaw(string &columnName, const uint8_t *data, uint64_t length);
+        virtual void columnTimestamp(string &columnName, struct tm &epochtime, uint64_t fraction, const char *tz);
+        virtual void appendRowid(typeobj objn, typeobj objd, typedba bdba, typeslot slot);
+        virtual void appendHeader(bool first);
+        virtual void appendSchema(OracleObject *object);
+
+        void appendLong(int64_t value);
+        void appendBytes(const uint8_t *data, uint64_t length);
+        void appendFingerprint(uint64_t fingerprint);
+        void appendControl(uint64_t op);
+        void appendRow(OracleObject *object, AvroSchema *schema, uint64_t type, uint64_t fallback);
+        AvroSchema *getSchema(OracleObject *object);
+        void buildSchema(OracleObject *object, AvroSchema *schema, string &canonical, string &full);
+        void buildControlSchema(string &canonical, string &full);
+        static void appendName(string &str, const string &name);
+
+        OutputBufferAvro(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
+                uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat, AvroRegistry *registry);
+
+    public:
+        OutputBufferAvro(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
+                uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat, const char *schemaPath);
+        virtual ~OutputBufferAvro();
+
+        virtual OutputBuffer *newFormatter(void);
+        virtual void processBegin(typescn scn, typetime time, typexid xid);
+        virtual void processCommit(void);
+        virtual void processRollback(typescn scn, typetime time, typexid xid);
+        virtual void processInsert(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
+        virtual void processUpdate(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
+        virtual void processDelete(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
+        virtual void processDDL(OracleObject *object, uint16_t type, uint16_t seq, const char *operation, const char *sql, uint64_t sqlLength);
+    };
+}
+
+#endif
@@ -17,18 +17,33 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <cfloat>
+#include <cmath>
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 #include "OracleAnalyzer.h"
 #include "OracleColumn.h"
 #include "OracleObject.h"
 #include "OutputBufferJson.h"
+#include "RuntimeException.h"
+#include "Ryu.h"
 
 namespace OpenLogReplicator {
 
+    escapeScanFn OutputBufferJson::escapeScan = OutputBufferJson::escapeScanSelect();
+
     OutputBufferJson::OutputBufferJson(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
             uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat) :
             OutputBuffer(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat),
             hasPreviousRedo(false),
-            hasPreviousColumn(false) {
+            hasPreviousColumn(false),
+            dateYear(0),
+            dateMon(0),
+            dateDay(0),
+            dateEpochDay(0),
+            dateLength(0) {
     }
 
     OutputBufferJson::~OutputBufferJson() {
@@ -54,11 +69,7 @@ namespace OpenLogReplicator {
         outputBufferAppend('"');
         outputBufferAppend(columnName);
         outputBufferAppend("\":");
-
-        stringstream valStringStream;
-        valStringStream << value;
-        string valString = valStringStream.str();
-        outputBufferAppend(valString);
+        appendFloat(value, FLT_DIG, true);
     }
 
     void OutputBufferJson::columnDouble(string &columnName, double value) {
@@ -70,11 +81,7 @@ namespace OpenLogReplicator {
         outputBufferAppend('"');
         outputBufferAppend(columnName);
         outputBufferAppend("\":");
-
-        stringstream valStringStream;
-        valStringStream << value;
-        string valString = valStringStream.str();
-        outputBufferAppend(valString);
+        appendFloat(value, DBL_DIG, false);
     }
 
     void OutputBufferJson::columnString(string &columnName) {
@@ -102,6 +109,18 @@ namespace OpenLogReplicator {
         outputBufferAppend(valueBuffer, valueLength);
     }
 
+    void OutputBufferJson::columnInt(string &columnName, uint64_t precision, uint64_t scale, int64_t value) {
+        if (hasPreviousColumn)
+            outputBufferAppend(',');
+        else
+            hasPreviousColumn = true;
+
+        outputBufferAppend('"');
+        outputBufferAppend(columnName);
+        outputBufferAppend("\":");
+        appendSDec(value);
+    }
+
     void OutputBufferJson::columnRaw(string &columnName, const uint8_t *data, uint64_t length) {
         if (hasPreviousColumn)
             outputBufferAppend(',');
@@ -111,8 +130,20 @@ namespace OpenLogReplicator {
         outputBufferAppend('"');
         outputBufferAppend(columnName);
         outputBufferAppend("\":\"");
-        for (uint64_t j = 0; j < length; ++j)
-            appendHex(*(data + j), 2);
+        while (length > 0) {
+            uint64_t size = length;
+            if (size > OUTPUT_BUFFER_RESERVE_SIZE / 2)
+                size = OUTPUT_BUFFER_RESERVE_SIZE / 2;
+
+            uint8_t *buffer = outputBufferReserve(size * 2);
+            for (uint64_t j = 0; j < size; ++j) {
+                buffer[j * 2] = map16[data[j] >> 4];
+                buffer[j * 2 + 1] = map16[data[j] & 0xF];
+            }
+            outputBufferReserveCommit(size * 2);
+            data += size;
+            length -= size;
+        }
         outputBufferAppend('"');
     }
 
@@ -126,70 +157,116 @@ namespace OpenLogReplicator {
         outputBufferAppend(columnName);
         outputBufferAppend("\":");
 
+        //rows of one transaction mostly share the date, recalculate only on change
+        if (epochtime.tm_year != dateYear || epochtime.tm_mon != dateMon || epochtime.tm_mday != dateDay)
+            updateDateCache(epochtime);
+
         if ((timestampFormat & TIMESTAMP_FORMAT_ISO8601) != 0) {
-            //2012-04-23T18:25:43.511Z - ISO 8601 format
-            outputBufferAppend('"');
-            if (epochtime.tm_year > 0) {
-                appendDec((uint64_t)epochtime.tm_year);
-            } else {
-                appendDec((uint64_t)(-epochtime.tm_year));
-                outputBufferAppend("BC");
-            }
-            outputBufferAppend('-');
-            appendDec(epochtime.tm_mon, 2);
-            outputBufferAppend('-');
-            appendDec(epochtime.tm_mday, 2);
-            outputBufferAppend('T');
-            appendDec(epochtime.tm_hour, 2);
-            outputBufferAppend(':');
-            appendDec(epochtime.tm_min, 2);
-            outputBufferAppend(':');
-            appendDec(epochtime.tm_sec, 2);
+            //2012-04-23T18:25:43.511Z - ISO 8601 format, fields kept in table range for malformed data
+            uint64_t hour = ((uint64_t)epochtime.tm_hour % 100) * 2,
+                    min = ((uint64_t)epochtime.tm_min % 100) * 2,
+                    sec = ((uint64_t)epochtime.tm_sec % 100) * 2;
+            uint8_t *buffer = outputBufferReserve(dateLength + 20);
+            uint64_t length = dateLength;
+            memcpy(buffer, date, dateLength);
+            buffer[length++] = map100[hour];
+            buffer[length++] = map100[hour + 1];
+            buffer[length++] = ':';
+            buffer[length++] = map100[min];
+            buffer[length++] = map100[min + 1];
+            buffer[length++] = ':';
+            buffer[length++] = map100[sec];
+            buffer[length++] = map100[sec + 1];
 
             if (fraction > 0) {
-                outputBufferAppend('.');
-                appendDec(fraction, 9);
+                buffer[length++] = '.';
+                buffer[length + 8] = '0' + (fraction % 10);
+                fraction /= 10;
+                for (int64_t i = 6; i >= 0; i -= 2) {
+                    uint64_t pair = (fraction % 100) * 2;
+                    fraction /= 100;
+                    buffer[length + i] = map100[pair];
+                    buffer[length + i + 1] = map100[pair + 1];
+                }
+                length += 9;
             }
 
+            if (tz == nullptr)
+                buffer[length++] = '"';
+            outputBufferReserveCommit(length);
+
             if (tz != nullptr) {
                 outputBufferAppend(' ');
                 outputBufferAppend(tz);
+                outputBufferAppend('"');
             }
-            outputBufferAppend('"');
         } else {
             //unix epoch format
             if (epochtime.tm_year >= 1900) {
-                --epochtime.tm_mon;
-                epochtime.tm_year -= 1900;
-                appendDec(tmToEpoch(&epochtime) * 1000 + ((fraction + 500000) / 1000000));
+                int64_t seconds = dateEpochDay * 86400 + epochtime.tm_hour * 3600 + epochtime.tm_min * 60 + epochtime.tm_sec;
+                appendDec(seconds * 1000 + ((fraction + 500000) / 1000000));
             } else
                 appendDec(0);
         }
     }
 
+    void OutputBufferJson::updateDateCache(struct tm &epochtime) {
+        dateYear = epochtime.tm_year;
+        dateMon = epochtime.tm_mon;
+        dateDay = epochtime.tm_mday;
+        dateEpochDay = epochDay(dateYear, dateMon, dateDay);
+
+        //"YYYY-MM-DDT" or "YYYYBC-MM-DDT" prefix
+        uint64_t year = (dateYear > 0) ? dateYear : -dateYear;
+        char buffer[8];
+        uint64_t yearLength = 0;
+        do {
+            buffer[yearLength++] = '0' + (year % 10);
+            year /= 10;
+        } while (year > 0);
+
+        dateLength = 0;
+        date[dateLength++] = '"';
+        while (yearLength > 0)
+            date[dateLength++] = buffer[--yearLength];
+        if (dateYear <= 0) {
+            date[dateLength++] = 'B';
+            date[dateLength++] = 'C';
+        }
+        date[dateLength++] = '-';
+        date[dateLength++] = map100[((uint64_t)dateMon % 100) * 2];
+        date[dateLength++] = map100[((uint64_t)dateMon % 100) * 2 + 1];
+        date[dateLength++] = '-';
+        date[dateLength++] = map100[((uint64_t)dateDay % 100) * 2];
+        date[dateLength++] = map100[((uint64_t)dateDay % 100) * 2 + 1];
+        date[dateLength++] = 'T';
+    }
+
     void OutputBufferJson::appendRowid(typeobj objn, typeobj objd, typedba bdba, typeslot slot) {
         uint32_t afn = bdba >> 22;
         bdba &= 0x003FFFFF;
         outputBufferAppend("\"rid\":\"");
-        outputBufferAppend(map64[(objd >> 30) & 0x3F]);
-        outputBufferAppend(map64[(objd >> 24) & 0x3F]);
-        outputBufferAppend(map64[(objd >> 18) & 0x3F]);
-        outputBufferAppend(map64[(objd >> 12) & 0x3F]);
-        outputBufferAppend(map64[(objd >> 6) & 0x3F]);
-        outputBufferAppend(map64[objd & 0x3F]);
-        outputBufferAppend(map64[(afn >> 12) & 0x3F]);
-        outputBufferAppend(map64[(afn >> 6) & 0x3F]);
-        outputBufferAppend(map64[afn & 0x3F]);
-        outputBufferAppend(map64[(bdba >> 30) & 0x3F]);
-        outputBufferAppend(map64[(bdba >> 24) & 0x3F]);
-        outputBufferAppend(map64[(bdba >> 18) & 0x3F]);
-        outputBufferAppend(map64[(bdba >> 12) & 0x3F]);
-        outputBufferAppend(map64[(bdba >> 6) & 0x3F]);
-        outputBufferAppend(map64[bdba & 0x3F]);
-        outputBufferAppend(map64[(slot >> 12) & 0x3F]);
-        outputBufferAppend(map64[(slot >> 6) & 0x3F]);
-        outputBufferAppend(map64[slot & 0x3F]);
-        outputBufferAppend('"');
+        uint8_t *buffer = outputBufferReserve(19);
+        buffer[0] = map64[(objd >> 30) & 0x3F];
+        buffer[1] = map64[(objd >> 24) & 0x3F];
+        buffer[2] = map64[(objd >> 18) & 0x3F];
+        buffer[3] = map64[(objd >> 12) & 0x3F];
+        buffer[4] = map64[(objd >> 6) & 0x3F];
+        buffer[5] = map64[objd & 0x3F];
+        buffer[6] = map64[(afn >> 12) & 0x3F];
+        buffer[7] = map64[(afn >> 6) & 0x3F];
+        buffer[8] = map64[afn & 0x3F];
+        buffer[9] = map64[(bdba >> 30) & 0x3F];
+        buffer[10] = map64[(bdba >> 24) & 0x3F];
+        buffer[11] = map64[(bdba >> 18) & 0x3F];
+        buffer[12] = map64[(bdba >> 12) & 0x3F];
+        buffer[13] = map64[(bdba >> 6) & 0x3F];
+        buffer[14] = map64[bdba & 0x3F];
+        buffer[15] = map64[(slot >> 12) & 0x3F];
+        buffer[16] = map64[(slot >> 6) & 0x3F];
+        buffer[17] = map64[slot & 0x3F];
+        buffer[18] = '"';
+        outputBufferReserveCommit(19);
     }
 
     void OutputBufferJson::appendHeader(bool first) {
@@ -231,6 +308,9 @@ namespace OpenLogReplicator {
             outputBufferAppend("\"xidn\":");
             appendDec(lastXid);
         }
+
+        if (provisional)
+            outputBufferAppend(",\"provisional\":true");
     }
 
     void OutputBufferJson::appendSchema(OracleObject *object) {
@@ -374,23 +454,23 @@ namespace OpenLogReplicator {
     }
 
     void OutputBufferJson::appendHex(uint64_t value, uint64_t length) {
+        uint8_t *buffer = outputBufferReserve(length);
         uint64_t j = (length - 1) * 4;
         for (uint64_t i = 0; i < length; ++i) {
-            outputBufferAppend(map16[(value >> j) & 0xF]);
+            buffer[i] = map16[(value >> j) & 0xF];
             j -= 4;
         };
+        outputBufferReserveCommit(length);
     }
 
     void OutputBufferJson::appendDec(uint64_t value, uint64_t length) {
-        char buffer[21];
+        uint8_t *buffer = outputBufferReserve(length);
 
-        for (uint i = 0; i < length; ++i) {
-            buffer[i] = '0' + (value % 10);
+        for (uint64_t i = 0; i < length; ++i) {
+            buffer[length - i - 1] = '0' + (value % 10);
             value /= 10;
         }
-
-        for (uint64_t i = 0; i < length; ++i)
-            outputBufferAppend(buffer[length - i - 1]);
+        outputBufferReserveCommit(length);
     }
 
     void OutputBufferJson::appendDec(uint64_t value) {
@@ -407,84 +487,236 @@ namespace OpenLogReplicator {
             }
         }
 
+        uint8_t *output = outputBufferReserve(length);
         for (uint64_t i = 0; i < length; ++i)
-            outputBufferAppend(buffer[length - i - 1]);
+            output[i] = buffer[length - i - 1];
+        outputBufferReserveCommit(length);
     }
 
     void OutputBufferJson::appendSDec(int64_t value) {
         char buffer[22];
-        uint64_t length = 0;
+        uint64_t length = 0, absValue = (value < 0) ? -value : value;
+
+        //two digits per lookup, written from the end
+        while (absValue >= 100) {
+            uint64_t pair = (absValue % 100) * 2;
+            absValue /= 100;
+            buffer[length++] = map100[pair + 1];
+            buffer[length++] = map100[pair];
+        }
+        if (absValue >= 10) {
+            buffer[length++] = map100[absValue * 2 + 1];
+            buffer[length++] = map100[absValue * 2];
+        } else
+            buffer[length++] = '0' + absValue;
+        if (value < 0)
+            buffer[length++] = '-';
+
+        uint8_t *output = outputBufferReserve(length);
+        for (uint64_t i = 0; i < length; ++i)
+            output[i] = buffer[length - i - 1];
+        outputBufferReserveCommit(length);
+    }
 
-        if (value == 0) {
-            buffer[0] = '0';
-            length = 1;
+    //shortest digits which read back to the same value, laid out like %.<n>g with n = max(minDigits, digits)
+    void OutputBufferJson::appendFloat(double value, int minDigits, bool single) {
+        char buffer[32];
+        int length = 0;
+
+        if (!isfinite(value)) {
+            length = snprintf(buffer, sizeof(buffer), "%g", value);
+        } else if (value == 0) {
+            if (signbit(value))
+                buffer[length++] = '-';
+            buffer[length++] = '0';
         } else {
-            if (value < 0) {
-                value = -value;
-                while (value > 0) {
-                    buffer[length++] = '0' + (value % 10);
-                    value /= 10;
-                }
+            uint64_t mantissa;
+            int32_t exponent;
+            if (single) {
+                uint32_t mantissa32;
+                Ryu::floatToDecimal((float)value, mantissa32, exponent);
+                mantissa = mantissa32;
+            } else
+                Ryu::doubleToDecimal(value, mantissa, exponent);
+
+            while (mantissa % 10 == 0) {
+                mantissa /= 10;
+                ++exponent;
+            }
+
+            //digits in reverse order
+            char digits[20];
+            int digitsLength = 0;
+            while (mantissa > 0) {
+                digits[digitsLength++] = '0' + (mantissa % 10);
+                mantissa /= 10;
+            }
+            int precision = (digitsLength > minDigits) ? digitsLength : minDigits;
+            int decimalExponent = exponent + digitsLength - 1;
+
+            if (value < 0)
                 buffer[length++] = '-';
+
+            if (decimalExponent < -4 || decimalExponent >= precision) {
+                buffer[length++] = digits[digitsLength - 1];
+                if (digitsLength > 1) {
+                    buffer[length++] = '.';
+                    for (int i = digitsLength - 2; i >= 0; --i)
+                        buffer[length++] = digits[i];
+                }
+                buffer[length++] = 'e';
+                if (decimalExponent < 0) {
+                    buffer[length++] = '-';
+                    decimalExponent = -decimalExponent;
+                } else
+                    buffer[length++] = '+';
+                if (decimalExponent >= 100)
+                    buffer[length++] = '0' + (decimalExponent / 100);
+                buffer[length++] = '0' + ((decimalExponent / 10) % 10);
+                buffer[length++] = '0' + (decimalExponent % 10);
+            } else if (decimalExponent < 0) {
+                buffer[length++] = '0';
+                buffer[length++] = '.';
+                for (int i = -1; i > decimalExponent; --i)
+                    buffer[length++] = '0';
+                for (int i = digitsLength - 1; i >= 0; --i)
+                    buffer[length++] = digits[i];
             } else {
-                while (value > 0) {
-                    buffer[length++] = '0' + (value % 10);
-                    value /= 10;
+                for (int i = 0; i <= decimalExponent; ++i)
+                    buffer[length++] = (i < digitsLength) ? digits[digitsLength - 1 - i] : '0';
+                if (digitsLength > decimalExponent + 1) {
+                    buffer[length++] = '.';
+                    for (int i = decimalExponent + 1; i < digitsLength; ++i)
+                        buffer[length++] = digits[digitsLength - 1 - i];
                 }
             }
         }
 
-        for (uint64_t i = 0; i < length; ++i)
-            outputBufferAppend(buffer[length - i - 1]);
+        uint8_t *output = outputBufferReserve(length);
+        memcpy(output, buffer, length);
+        outputBufferReserveCommit(length);
     }
 
     void OutputBufferJson::appendEscape(const char *str, uint64_t length) {
         while (length > 0) {
-            if (*str == '\t') {
-                outputBufferAppend('\\');
-                outputBufferAppend('t');
-            } else if (*str == '\r') {
-                outputBufferAppend('\\');
-                outputBufferAppend('r');
-            } else if (*str == '\n') {
-                outputBufferAppend('\\');
-                outputBufferAppend('n');
-            } else if (*str == '\f') {
-                outputBufferAppend('\\');
-                outputBufferAppend('f');
-            } else if (*str == '\b') {
-                outputBufferAppend('\\');
-                outputBufferAppend('b');
-            } else {
-                if (*str == '"' || *str == '\\' || *str == '/')
-                    outputBufferAppend('\\');
-                outputBufferAppend(*(str++));
+            //every character takes at most 2 bytes after escaping
+            uint64_t size = length;
+            if (size > OUTPUT_BUFFER_RESERVE_SIZE / 2)
+                size = OUTPUT_BUFFER_RESERVE_SIZE / 2;
+
+            uint8_t *buffer = outputBufferReserve(size * 2);
+            uint64_t pos = 0, i = 0;
+            while (i < size) {
+                //run of characters not needing escape is copied at once
+                uint64_t clean = escapeScan(str + i, size - i);
+                memcpy(buffer + pos, str + i, clean);
+                pos += clean;
+                i += clean;
+                if (i == size)
+                    break;
+
+                buffer[pos++] = '\\';
+                switch (str[i]) {
+                case '\t': buffer[pos++] = 't'; break;
+                case '\r': buffer[pos++] = 'r'; break;
+                case '\n': buffer[pos++] = 'n'; break;
+                case '\f': buffer[pos++] = 'f'; break;
+                case '\b': buffer[pos++] = 'b'; break;
+                default: buffer[pos++] = str[i];
+                }
+                ++i;
+            }
+            outputBufferReserveCommit(pos);
+            str += size;
+            length -= size;
+        }
+    }
+
+    //length of prefix without characters to escape: " \ / \b \t \n \f \r
+    uint64_t OutputBufferJson::escapeScanScalar(const char *str, uint64_t length) {
+        for (uint64_t i = 0; i < length; ++i) {
+            switch (str[i]) {
+            case '"':
+            case '\\':
+            case '/':
+            case '\b':
+            case '\t':
+            case '\n':
+            case '\f':
+            case '\r':
+                return i;
             }
-            --length;
         }
+        return length;
     }
 
-    time_t OutputBufferJson::tmToEpoch(struct tm *epoch) {
-        static const int cumdays[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
-        uint64_t year;
-        time_t result;
-
-        year = 1900 + epoch->tm_year + epoch->tm_mon / 12;
-        result = (year - 1970) * 365 + cumdays[epoch->tm_mon % 12];
-        result += (year - 1968) / 4;
-        result -= (year - 1900) / 100;
-        result += (year - 1600) / 400;
-        if ((year % 4) == 0 && ((year % 100) != 0 || (year % 400) == 0) &&
-            (epoch->tm_mon % 12) < 2)
-            result--;
-        result += epoch->tm_mday - 1;
-        result *= 24;
-        result += epoch->tm_hour;
-        result *= 60;
-        result += epoch->tm_min;
-        result *= 60;
-        result += epoch->tm_sec;
-        return result;
+#ifdef __x86_64__
+    uint64_t OutputBufferJson::escapeScanSSE2(const char *str, uint64_t length) {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i slash = _mm_set1_epi8('/');
+        const __m128i ctrlLow = _mm_set1_epi8('\b' - 1);
+        const __m128i ctrlHigh = _mm_set1_epi8('\r' + 1);
+        const __m128i vt = _mm_set1_epi8('\v');
+        uint64_t i = 0;
+
+        for (; i + 16 <= length; i += 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(str + i));
+            //\b..\r except \v, bytes >= 0x80 are negative and fail the range check
+            __m128i ctrl = _mm_andnot_si128(_mm_cmpeq_epi8(chunk, vt),
+                    _mm_and_si128(_mm_cmpgt_epi8(chunk, ctrlLow), _mm_cmplt_epi8(chunk, ctrlHigh)));
+            __m128i mask = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, slash), ctrl));
+            uint32_t bits = _mm_movemask_epi8(mask);
+            if (bits != 0)
+                return i + __builtin_ctz(bits);
+        }
+
+        return i + escapeScanScalar(str + i, length - i);
+    }
+
+    __attribute__((target("avx2")))
+    uint64_t OutputBufferJson::escapeScanAVX2(const char *str, uint64_t length) {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i slash = _mm256_set1_epi8('/');
+        const __m256i ctrlLow = _mm256_set1_epi8('\b' - 1);
+        const __m256i ctrlHigh = _mm256_set1_epi8('\r' + 1);
+        const __m256i vt = _mm256_set1_epi8('\v');
+        uint64_t i = 0;
+
+        for (; i + 32 <= length; i += 32) {
+            __m256i chunk = _mm256_loadu_si256((const __m256i*)(str + i));
+            __m256i ctrl = _mm256_andnot_si256(_mm256_cmpeq_epi8(chunk, vt),
+                    _mm256_and_si256(_mm256_cmpgt_epi8(chunk, ctrlLow), _mm256_cmpgt_epi8(ctrlHigh, chunk)));
+            __m256i mask = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, slash), ctrl));
+            uint32_t bits = _mm256_movemask_epi8(mask);
+            if (bits != 0)
+                return i + __builtin_ctz(bits);
+        }
+
+        return i + escapeScanSSE2(str + i, length - i);
+    }
+#endif
+
+    escapeScanFn OutputBufferJson::escapeScanSelect(void) {
+#ifdef __x86_64__
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return escapeScanAVX2;
+        return escapeScanSSE2;
+#else
+        return escapeScanScalar;
+#endif
+    }
+
+    OutputBuffer *OutputBufferJson::newFormatter(void) {
+        OutputBuffer *formatter = new OutputBufferJson(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat);
+        if (formatter == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OutputBufferJson) << " bytes memory (for: formatter)");
+        }
+        return formatter;
     }
 
     void OutputBufferJson::processBegin(typescn scn, typetime time, typexid xid) {
@@ -517,6 +749,18 @@ namespace OpenLogReplicator {
         outputBufferCommit();
     }
 
+    void OutputBufferJson::processRollback(typescn scn, typetime time, typexid xid) {
+        lastTime = time;
+        lastScn = scn;
+        lastXid = xid;
+
+        outputBufferBegin(0);
+        outputBufferAppend('{');
+        appendHeader(true);
+        outputBufferAppend(",\"payload\":[{\"op\":\"rollback\"}]}");
+        outputBufferCommit();
+    }
+
     void OutputBufferJson::processInsert(OracleObject *object, typedba bdba, typeslot slot, typexid xid) {
         if (messageFormat == MESSAGE_FORMAT_FULL) {
             if (hasPreviousRedo)
@@ -525,6 +769,7 @@ namespace OpenLogReplicator {
                 hasPreviousRedo = true;
         } else {
             outputBufferBegin(object->objn);
+            outputBufferKey(object, bdba, slot, VALUE_AFTER, VALUE_BEFORE);
             outputBufferAppend('{');
             appendHeader(false);
             outputBufferAppend(",\"payload\":[");
@@ -537,17 +782,16 @@ namespace OpenLogReplicator {
         outputBufferAppend(",\"after\":{");
 
         hasPreviousColumn = false;
-        for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-            uint16_t i = (*it).first;
-            uint16_t pos = (*it).second;
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
 
             if (object->columns[i]->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
                 continue;
             if (object->columns[i]->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
                 continue;
 
-            if (values[pos][VALUE_AFTER].data[0] != nullptr && values[pos][VALUE_AFTER].length[0] > 0)
-                processValue(object->columns[i], values[pos][VALUE_AFTER].data[0], values[pos][VALUE_AFTER].length[0], object->columns[i]->typeNo, object->columns[i]->charsetId);
+            if (valuePresent(i, VALUE_AFTER) && values[i][VALUE_AFTER].length[0] > 0)
+                processValue(object->columns[i], values[i][VALUE_AFTER].data[0], values[i][VALUE_AFTER].length[0]);
             else
             if (columnFormat >= COLUMN_FORMAT_INS_DEC || object->columns[i]->numPk > 0)
                 columnNull(object->columns[i]);
@@ -568,6 +812,7 @@ namespace OpenLogReplicator {
                 hasPreviousRedo = true;
         } else {
             outputBufferBegin(object->objn);
+            outputBufferKey(object, bdba, slot, VALUE_AFTER, VALUE_BEFORE);
             outputBufferAppend('{');
             appendHeader(false);
             outputBufferAppend(",\"payload\":[");
@@ -580,38 +825,36 @@ namespace OpenLogReplicator {
         outputBufferAppend(",\"before\":{");
 
         hasPreviousColumn = false;
-        for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-            uint16_t i = (*it).first;
-            uint16_t pos = (*it).second;
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
 
             if (object->columns[i]->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
                 continue;
             if (object->columns[i]->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
                 continue;
 
-            if (values[pos][VALUE_BEFORE].data[0] != nullptr && values[pos][VALUE_BEFORE].length[0] > 0)
-                processValue(object->columns[i], values[pos][VALUE_BEFORE].data[0], values[pos][VALUE_BEFORE].length[0], object->columns[i]->typeNo, object->columns[i]->charsetId);
+            if (valuePresent(i, VALUE_BEFORE) && values[i][VALUE_BEFORE].length[0] > 0)
+                processValue(object->columns[i], values[i][VALUE_BEFORE].data[0], values[i][VALUE_BEFORE].length[0]);
             else
-            if (values[pos][VALUE_AFTER].data[0] != nullptr || values[pos][VALUE_BEFORE].data[0] != nullptr)
+            if (valuePresent(i, VALUE_AFTER) || valuePresent(i, VALUE_BEFORE))
                 columnNull(object->columns[i]);
         }
 
         outputBufferAppend("},\"after\":{");
 
         hasPreviousColumn = false;
-        for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-            uint16_t i = (*it).first;
-            uint16_t pos = (*it).second;
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
 
             if (object->columns[i]->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
                 continue;
             if (object->columns[i]->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
                 continue;
 
-            if (values[pos][VALUE_AFTER].data[0] != nullptr && values[pos][VALUE_AFTER].length[0] > 0)
-                processValue(object->columns[i], values[pos][VALUE_AFTER].data[0], values[pos][VALUE_AFTER].length[0], object->columns[i]->typeNo, object->columns[i]->charsetId);
+            if (valuePresent(i, VALUE_AFTER) && values[i][VALUE_AFTER].length[0] > 0)
+                processValue(object->columns[i], values[i][VALUE_AFTER].data[0], values[i][VALUE_AFTER].length[0]);
             else
-            if (values[pos][VALUE_AFTER].data[0] != nullptr || values[pos][VALUE_BEFORE].data[0] != nullptr)
+            if (valuePresent(i, VALUE_AFTER) || valuePresent(i, VALUE_BEFORE))
                 columnNull(object->columns[i]);
         }
         outputBufferAppend("}}");
@@ -630,6 +873,7 @@ namespace OpenLogReplicator {
                 hasPreviousRedo = true;
         } else {
             outputBufferBegin(object->objn);
+            outputBufferKey(object, bdba, slot, VALUE_BEFORE, VALUE_AFTER);
             outputBufferAppend('{');
             appendHeader(false);
             outputBufferAppend(",\"payload\":[");
@@ -642,17 +886,16 @@ namespace OpenLogReplicator {
         outputBufferAppend(",\"before\":{");
 
         hasPreviousColumn = false;
-        for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-            uint16_t i = (*it).first;
-            uint16_t pos = (*it).second;
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
 
             if (object->columns[i]->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
                 continue;
             if (object->columns[i]->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
                 continue;
 
-            if (values[pos][VALUE_BEFORE].data[0] != nullptr && values[pos][VALUE_BEFORE].length[0] > 0)
-                processValue(object->columns[i], values[pos][VALUE_BEFORE].data[0], values[pos][VALUE_BEFORE].length[0], object->columns[i]->typeNo, object->columns[i]->charsetId);
+            if (valuePresent(i, VALUE_BEFORE) && values[i][VALUE_BEFORE].length[0] > 0)
+                processValue(object->columns[i], values[i][VALUE_BEFORE].data[0], values[i][VALUE_BEFORE].length[0]);
             else
             if (columnFormat >= COLUMN_FORMAT_INS_DEC || object->columns[i]->numPk > 0)
                 columnNull(object->columns[i]);
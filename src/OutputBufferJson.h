@@ -26,15 +26,25 @@ using namespace std;
 
 namespace OpenLogReplicator {
 
+    typedef uint64_t (*escapeScanFn)(const char *str, uint64_t length);
+
     class OutputBufferJson : public OutputBuffer {
     protected:
+        static escapeScanFn escapeScan;
         bool hasPreviousRedo;
         bool hasPreviousColumn;
+        int dateYear;
+        int dateMon;
+        int dateDay;
+        int64_t dateEpochDay;
+        uint64_t dateLength;
+        uint8_t date[16];
         virtual void columnNull(OracleColumn *column);
         virtual void columnFloat(string &columnName, float value);
         virtual void columnDouble(string &columnName, double value);
         virtual void columnString(string &columnName);
         virtual void columnNumber(string &columnName, uint64_t precision, uint64_t scale);
+        virtual void columnInt(string &columnName, uint64_t precision, uint64_t scale, int64_t value);
         virtual void columnRaw(string &columnName, const uint8_t *data, uint64_t length);
         virtual void columnTimestamp(string &columnName, struct tm &epochtime, uint64_t fraction, const char *tz);
         virtual void appendRowid(typeobj objn, typeobj objd, typedba bdba, typeslot slot);
@@ -45,15 +55,24 @@ namespace OpenLogReplicator {
         void appendDec(uint64_t value, uint64_t length);
         void appendDec(uint64_t value);
         void appendSDec(int64_t value);
+        void appendFloat(double value, int minDigits, bool single);
         void appendEscape(const char *str, uint64_t length);
-        time_t tmToEpoch(struct tm *epoch);
+        static uint64_t escapeScanScalar(const char *str, uint64_t length);
+#ifdef __x86_64__
+        static uint64_t escapeScanSSE2(const char *str, uint64_t length);
+        static uint64_t escapeScanAVX2(const char *str, uint64_t length);
+#endif
+        static escapeScanFn escapeScanSelect(void);
+        void updateDateCache(struct tm &epochtime);
     public:
         OutputBufferJson(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
                 uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat);
         virtual ~OutputBufferJson();
 
+        virtual OutputBuffer *newFormatter(void);
         virtual void processBegin(typescn scn, typetime time, typexid xid);
         virtual void processCommit(void);
+        virtual void processRollback(typescn scn, typetime time, typexid xid);
         virtual void processInsert(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
         virtual void processUpdate(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
         virtual void processDelete(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
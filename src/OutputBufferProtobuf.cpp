@@ -31,16 +31,65 @@ namespace OpenLogReplicator {
             redoResponsePB(nullptr),
             valuePB(nullptr),
             payloadPB(nullptr),
-            schemaPB(nullptr) {
+            schemaPB(nullptr),
+            arena(nullptr),
+            serializeBuffer(nullptr),
+            serializeBufferSize(0) {
         GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+        arena = new google::protobuf::Arena();
+        if (arena == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(google::protobuf::Arena) << " bytes memory (for: protobuf arena)");
+        }
     }
 
     OutputBufferProtobuf::~OutputBufferProtobuf() {
-        if (redoResponsePB != nullptr) {
-            delete redoResponsePB;
-            redoResponsePB = nullptr;
+        //messages are owned by the arena
+        redoResponsePB = nullptr;
+        if (arena != nullptr) {
+            delete arena;
+            arena = nullptr;
+        }
+        if (serializeBuffer != nullptr) {
+            delete[] serializeBuffer;
+            serializeBuffer = nullptr;
         }
-        google::protobuf::ShutdownProtobufLibrary();
+    }
+
+    //message is serialized in place when it fits in the output buffer, arena memory is reused for the next message
+    void OutputBufferProtobuf::serializeResponse(const char *operation) {
+        uint64_t size = redoResponsePB->ByteSizeLong();
+        bool inPlace = (size <= OUTPUT_BUFFER_RESERVE_SIZE || lastBuffer->length + size < OUTPUT_BUFFER_DATA_SIZE);
+        uint8_t *output;
+
+        if (inPlace)
+            output = outputBufferReserve(size);
+        else {
+            if (serializeBufferSize < size) {
+                if (serializeBuffer != nullptr)
+                    delete[] serializeBuffer;
+                serializeBufferSize = 0;
+                serializeBuffer = new uint8_t[size];
+                if (serializeBuffer == nullptr) {
+                    RUNTIME_FAIL("couldn't allocate " << dec << size << " bytes memory (for: protobuf message)");
+                }
+                serializeBufferSize = size;
+            }
+            output = serializeBuffer;
+        }
+
+        uint8_t *end = redoResponsePB->SerializeWithCachedSizesToArray(output);
+        redoResponsePB = nullptr;
+        arena->Reset();
+
+        if (end != output + size) {
+            RUNTIME_FAIL("ERROR, PB " << operation << " processing failed, error serializing to buffer");
+        }
+
+        if (inPlace)
+            outputBufferReserveCommit(size);
+        else
+            outputBufferAppend(serializeBuffer, size);
     }
 
     void OutputBufferProtobuf::columnNull(OracleColumn *column) {
@@ -85,6 +134,21 @@ namespace OpenLogReplicator {
         }
     }
 
+    void OutputBufferProtobuf::columnInt(string &columnName, uint64_t precision, uint64_t scale, int64_t value) {
+        valuePB->set_name(columnName);
+
+        if (scale == 0 && precision <= 17)
+            valuePB->set_value_int(value);
+        else
+        if (precision <= 6 && scale < 38)
+            valuePB->set_value_float(value);
+        else
+        if (precision <= 15 && scale <= 307)
+            valuePB->set_value_double(value);
+        else
+            valuePB->set_value_string(to_string(value));
+    }
+
     void OutputBufferProtobuf::columnRaw(string &columnName, const uint8_t *data, uint64_t length) {
         valuePB->set_name(columnName);
     }
@@ -282,6 +346,14 @@ namespace OpenLogReplicator {
         buf[length] = 0;
     }
 
+    OutputBuffer *OutputBufferProtobuf::newFormatter(void) {
+        OutputBuffer *formatter = new OutputBufferProtobuf(messageFormat, xidFormat, timestampFormat, charFormat, scnFormat, unknownFormat, schemaFormat, columnFormat);
+        if (formatter == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OutputBufferProtobuf) << " bytes memory (for: formatter)");
+        }
+        return formatter;
+    }
+
     void OutputBufferProtobuf::processBegin(typescn scn, typetime time, typexid xid) {
         lastTime = time;
         lastScn = scn;
@@ -291,7 +363,7 @@ namespace OpenLogReplicator {
         if (redoResponsePB != nullptr) {
             RUNTIME_FAIL("ERROR, PB begin processing failed, message already exists, internal error");
         }
-        redoResponsePB = new pb::RedoResponse;
+        redoResponsePB = google::protobuf::Arena::CreateMessage<pb::RedoResponse>(arena);
         appendHeader(true);
 
         if (messageFormat == MESSAGE_FORMAT_SHORT) {
@@ -299,15 +371,7 @@ namespace OpenLogReplicator {
             payloadPB = redoResponsePB->mutable_payload(redoResponsePB->payload_size() - 1);
             payloadPB->set_op(pb::BEGIN);
 
-            string output;
-            bool ret = redoResponsePB->SerializeToString(&output);
-            delete redoResponsePB;
-            redoResponsePB = nullptr;
-
-            if (!ret) {
-                RUNTIME_FAIL("ERROR, PB begin processing failed, error serializing to string");
-            }
-            outputBufferAppend(output);
+            serializeResponse("begin");
             outputBufferCommit();
         }
     }
@@ -322,7 +386,7 @@ namespace OpenLogReplicator {
                 RUNTIME_FAIL("ERROR, PB commit processing failed, message already exists, internal error");
             }
             outputBufferBegin(0);
-            redoResponsePB = new pb::RedoResponse;
+            redoResponsePB = google::protobuf::Arena::CreateMessage<pb::RedoResponse>(arena);
             appendHeader(true);
 
             redoResponsePB->add_payload();
@@ -330,18 +394,14 @@ namespace OpenLogReplicator {
             payloadPB->set_op(pb::COMMIT);
         }
 
-        string output;
-        bool ret = redoResponsePB->SerializeToString(&output);
-        delete redoResponsePB;
-        redoResponsePB = nullptr;
-
-        if (!ret) {
-            RUNTIME_FAIL("ERROR, PB commit processing failed, error serializing to string");
-        }
-        outputBufferAppend(output);
+        serializeResponse("commit");
         outputBufferCommit();
     }
 
+    void OutputBufferProtobuf::processRollback(typescn scn, typetime time, typexid xid) {
+        RUNTIME_FAIL("ERROR, PB rollback marker is not supported, streaming of transactions requires JSON format");
+    }
+
     void OutputBufferProtobuf::processInsert(OracleObject *object, typedba bdba, typeslot slot, typexid xid) {
         if (messageFormat == MESSAGE_FORMAT_FULL) {
             if (redoResponsePB == nullptr) {
@@ -352,7 +412,8 @@ namespace OpenLogReplicator {
                 RUNTIME_FAIL("ERROR, PB insert processing failed, message already exists, internal error");
             }
             outputBufferBegin(object->objn);
-            redoResponsePB = new pb::RedoResponse;
+            outputBufferKey(object, bdba, slot, VALUE_AFTER, VALUE_BEFORE);
+            redoResponsePB = google::protobuf::Arena::CreateMessage<pb::RedoResponse>(arena);
             appendHeader(true);
         }
 
@@ -365,19 +426,18 @@ namespace OpenLogReplicator {
 
         appendRowid(object->objn, object->objd, bdba, slot);
 
-        for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-            uint16_t i = (*it).first;
-            uint16_t pos = (*it).second;
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
 
             if (object->columns[i]->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
                 continue;
             if (object->columns[i]->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
                 continue;
 
-            if (values[pos][VALUE_AFTER].data[0] != nullptr && values[pos][VALUE_AFTER].length[0] > 0) {
+            if (valuePresent(i, VALUE_AFTER) && values[i][VALUE_AFTER].length[0] > 0) {
                 payloadPB->add_after();
                 valuePB = payloadPB->mutable_after(payloadPB->after_size() - 1);
-                processValue(object->columns[i], values[pos][VALUE_AFTER].data[0], values[pos][VALUE_AFTER].length[0], object->columns[i]->typeNo, object->columns[i]->charsetId);
+                processValue(object->columns[i], values[i][VALUE_AFTER].data[0], values[i][VALUE_AFTER].length[0]);
             } else
             if (columnFormat >= COLUMN_FORMAT_INS_DEC || object->columns[i]->numPk > 0) {
                 payloadPB->add_after();
@@ -387,15 +447,7 @@ namespace OpenLogReplicator {
         }
 
         if (messageFormat == MESSAGE_FORMAT_SHORT) {
-            string output;
-            bool ret = redoResponsePB->SerializeToString(&output);
-            delete redoResponsePB;
-            redoResponsePB = nullptr;
-
-            if (!ret) {
-                RUNTIME_FAIL("ERROR, PB insert processing failed, error serializing to string");
-            }
-            outputBufferAppend(output);
+            serializeResponse("insert");
             outputBufferCommit();
         }
     }
@@ -410,7 +462,8 @@ namespace OpenLogReplicator {
                 RUNTIME_FAIL("ERROR, PB update processing failed, message already exists, internal error");
             }
             outputBufferBegin(object->objn);
-            redoResponsePB = new pb::RedoResponse;
+            outputBufferKey(object, bdba, slot, VALUE_AFTER, VALUE_BEFORE);
+            redoResponsePB = google::protobuf::Arena::CreateMessage<pb::RedoResponse>(arena);
             appendHeader(true);
         }
 
@@ -423,42 +476,40 @@ namespace OpenLogReplicator {
 
         appendRowid(object->objn, object->objd, bdba, slot);
 
-        for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-            uint16_t i = (*it).first;
-            uint16_t pos = (*it).second;
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
 
             if (object->columns[i]->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
                 continue;
             if (object->columns[i]->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
                 continue;
 
-            if (values[pos][VALUE_BEFORE].data[0] != nullptr && values[pos][VALUE_BEFORE].length[0] > 0) {
+            if (valuePresent(i, VALUE_BEFORE) && values[i][VALUE_BEFORE].length[0] > 0) {
                 payloadPB->add_before();
                 valuePB = payloadPB->mutable_before(payloadPB->before_size() - 1);
-                processValue(object->columns[i], values[pos][VALUE_BEFORE].data[0], values[pos][VALUE_BEFORE].length[0], object->columns[i]->typeNo, object->columns[i]->charsetId);
+                processValue(object->columns[i], values[i][VALUE_BEFORE].data[0], values[i][VALUE_BEFORE].length[0]);
             } else
-            if (values[pos][VALUE_AFTER].data[0] != nullptr || values[pos][VALUE_BEFORE].data[0] > 0) {
+            if (valuePresent(i, VALUE_AFTER) || valuePresent(i, VALUE_BEFORE)) {
                 payloadPB->add_before();
                 valuePB = payloadPB->mutable_before(payloadPB->before_size() - 1);
                 columnNull(object->columns[i]);
             }
         }
 
-        for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-            uint16_t i = (*it).first;
-            uint16_t pos = (*it).second;
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
 
             if (object->columns[i]->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
                 continue;
             if (object->columns[i]->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
                 continue;
 
-            if (values[pos][VALUE_AFTER].data[0] != nullptr && values[pos][VALUE_AFTER].length[0] > 0) {
+            if (valuePresent(i, VALUE_AFTER) && values[i][VALUE_AFTER].length[0] > 0) {
                 payloadPB->add_after();
                 valuePB = payloadPB->mutable_after(payloadPB->after_size() - 1);
-                processValue(object->columns[i], values[pos][VALUE_AFTER].data[0], values[pos][VALUE_AFTER].length[0], object->columns[i]->typeNo, object->columns[i]->charsetId);
+                processValue(object->columns[i], values[i][VALUE_AFTER].data[0], values[i][VALUE_AFTER].length[0]);
             } else
-            if (values[pos][VALUE_AFTER].data[0] != nullptr || values[pos][VALUE_BEFORE].data[0] != nullptr) {
+            if (valuePresent(i, VALUE_AFTER) || valuePresent(i, VALUE_BEFORE)) {
                 payloadPB->add_after();
                 valuePB = payloadPB->mutable_after(payloadPB->after_size() - 1);
                 columnNull(object->columns[i]);
@@ -466,15 +517,7 @@ namespace OpenLogReplicator {
         }
 
         if (messageFormat == MESSAGE_FORMAT_SHORT) {
-            string output;
-            bool ret = redoResponsePB->SerializeToString(&output);
-            delete redoResponsePB;
-            redoResponsePB = nullptr;
-
-            if (!ret) {
-                RUNTIME_FAIL("ERROR, PB update processing failed, error serializing to string");
-            }
-            outputBufferAppend(output);
+            serializeResponse("update");
             outputBufferCommit();
         }
     }
@@ -489,7 +532,8 @@ namespace OpenLogReplicator {
                 RUNTIME_FAIL("ERROR, PB delete processing failed, message already exists, internal error");
             }
             outputBufferBegin(object->objn);
-            redoResponsePB = new pb::RedoResponse;
+            outputBufferKey(object, bdba, slot, VALUE_BEFORE, VALUE_AFTER);
+            redoResponsePB = google::protobuf::Arena::CreateMessage<pb::RedoResponse>(arena);
             appendHeader(true);
         }
 
@@ -502,19 +546,18 @@ namespace OpenLogReplicator {
 
         appendRowid(object->objn, object->objd, bdba, slot);
 
-        for (auto it = valuesMap.cbegin(); it != valuesMap.cend(); ++it) {
-            uint16_t i = (*it).first;
-            uint16_t pos = (*it).second;
+        for (uint64_t n = 0; n < valuesMax; ++n) {
+            uint16_t i = valuesCols[n];
 
             if (object->columns[i]->constraint && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_CONSTRAINT_COLUMNS) == 0)
                 continue;
             if (object->columns[i]->invisible && (oracleAnalyzer->flags & REDO_FLAGS_SHOW_INVISIBLE_COLUMNS) == 0)
                 continue;
 
-            if (values[pos][VALUE_BEFORE].data[0] != nullptr && values[pos][VALUE_BEFORE].length[0] > 0) {
+            if (valuePresent(i, VALUE_BEFORE) && values[i][VALUE_BEFORE].length[0] > 0) {
                 payloadPB->add_before();
                 valuePB = payloadPB->mutable_before(payloadPB->before_size() - 1);
-                processValue(object->columns[i], values[pos][VALUE_BEFORE].data[0], values[pos][VALUE_BEFORE].length[0], object->columns[i]->typeNo, object->columns[i]->charsetId);
+                processValue(object->columns[i], values[i][VALUE_BEFORE].data[0], values[i][VALUE_BEFORE].length[0]);
             } else
             if (columnFormat >= COLUMN_FORMAT_INS_DEC || object->columns[i]->numPk > 0) {
                 payloadPB->add_before();
@@ -524,15 +567,7 @@ namespace OpenLogReplicator {
         }
 
         if (messageFormat == MESSAGE_FORMAT_SHORT) {
-            string output;
-            bool ret = redoResponsePB->SerializeToString(&output);
-            delete redoResponsePB;
-            redoResponsePB = nullptr;
-
-            if (!ret) {
-                RUNTIME_FAIL("ERROR, PB delete processing failed, error serializing to string");
-            }
-            outputBufferAppend(output);
+            serializeResponse("delete");
             outputBufferCommit();
         }
     }
@@ -546,7 +581,7 @@ namespace OpenLogReplicator {
             if (redoResponsePB != nullptr) {
                 RUNTIME_FAIL("ERROR, PB commit processing failed, message already exists, internal error");
             }
-            redoResponsePB = new pb::RedoResponse;
+            redoResponsePB = google::protobuf::Arena::CreateMessage<pb::RedoResponse>(arena);
             appendHeader(true);
 
             redoResponsePB->add_payload();
@@ -556,15 +591,7 @@ namespace OpenLogReplicator {
         }
 
         if (messageFormat == MESSAGE_FORMAT_SHORT) {
-            string output;
-            bool ret = redoResponsePB->SerializeToString(&output);
-            delete redoResponsePB;
-            redoResponsePB = nullptr;
-
-            if (!ret) {
-                RUNTIME_FAIL("ERROR, PB commit processing failed, error serializing to string");
-            }
-            outputBufferAppend(output);
+            serializeResponse("commit");
         }
         outputBufferCommit();
     }
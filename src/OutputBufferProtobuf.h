@@ -33,25 +33,32 @@ protected:
         pb::Value *valuePB;
         pb::Payload *payloadPB;
         pb::Schema *schemaPB;
+        google::protobuf::Arena *arena;
+        uint8_t *serializeBuffer;
+        uint64_t serializeBufferSize;
 
         virtual void columnNull(OracleColumn *column);
         virtual void columnFloat(string &columnName, float value);
         virtual void columnDouble(string &columnName, double value);
         virtual void columnString(string &columnName);
         virtual void columnNumber(string &columnName, uint64_t precision, uint64_t scale);
+        virtual void columnInt(string &columnName, uint64_t precision, uint64_t scale, int64_t value);
         virtual void columnRaw(string &columnName, const uint8_t *data, uint64_t length);
         virtual void columnTimestamp(string &columnName, struct tm &time, uint64_t fraction, const char *tz);
         virtual void appendRowid(typeobj objn, typeobj objd, typedba bdba, typeslot slot);
         virtual void appendHeader(bool first);
         virtual void appendSchema(OracleObject *object);
         void numToString(uint64_t value, char *buf, uint64_t length);
+        void serializeResponse(const char *operation);
 public:
         OutputBufferProtobuf(uint64_t messageFormat, uint64_t xidFormat, uint64_t timestampFormat, uint64_t charFormat, uint64_t scnFormat,
                 uint64_t unknownFormat, uint64_t schemaFormat, uint64_t columnFormat);
         virtual ~OutputBufferProtobuf();
 
+        virtual OutputBuffer *newFormatter(void);
         virtual void processBegin(typescn scn, typetime time, typexid xid);
         virtual void processCommit(void);
+        virtual void processRollback(typescn scn, typetime time, typexid xid);
         virtual void processInsert(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
         virtual void processUpdate(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
         virtual void processDelete(OracleObject *object, typedba bdba, typeslot slot, typexid xid);
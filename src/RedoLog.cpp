@@ -36,12 +36,16 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "OpCode1801.h"
 #include "OracleAnalyzer.h"
 #include "OracleObject.h"
+#include "OutputBuffer.h"
 #include "Reader.h"
 #include "RedoLog.h"
 #include "RedoLogException.h"
 #include "RuntimeException.h"
 #include "Schema.h"
 #include "Transaction.h"
+#include "TransactionBuffer.h"
+#include "TransactionSnapshot.h"
+#include "TransactionStats.h"
 
 using namespace std;
 
@@ -51,7 +55,10 @@ namespace OpenLogReplicator {
 
     RedoLog::RedoLog(OracleAnalyzer *oracleAnalyzer, int64_t group, const char *path) :
             oracleAnalyzer(oracleAnalyzer),
+            opCodes(nullptr),
+            redoLogRecords(nullptr),
             vectors(0),
+            lwnDecodeRecords(0),
             lwnConfirmedBlock(2),
             lwnAllocated(0),
             lwnTimestamp(0),
@@ -68,19 +75,25 @@ namespace OpenLogReplicator {
 
         lwnChunks[0] = oracleAnalyzer->getMemoryChunk("LWN", false);
         uint64_t *length = (uint64_t *)lwnChunks[0];
-        *length = sizeof(uint64_t);
+        length[0] = LWN_CHUNK_HEADER_SIZE;
+        length[1] = 1;
         lwnAllocated = 1;
     }
 
     RedoLog::~RedoLog() {
         while (lwnAllocated > 0)
-            oracleAnalyzer->freeMemoryChunk("LWN", lwnChunks[--lwnAllocated], false);
+            oracleAnalyzer->transactionBuffer->releaseLwnChunk(lwnChunks[--lwnAllocated]);
 
-        for (uint64_t i = 0; i < vectors; ++i) {
-            if (opCodes[i] != nullptr) {
-                delete opCodes[i];
-                opCodes[i] = nullptr;
-            }
+        freeLwnDecode();
+
+        if (opCodes != nullptr) {
+            delete[] opCodes;
+            opCodes = nullptr;
+        }
+
+        if (redoLogRecords != nullptr) {
+            delete[] redoLogRecords;
+            redoLogRecords = nullptr;
         }
     }
 
@@ -254,23 +267,14 @@ namespace OpenLogReplicator {
     }
 
     void RedoLog::analyzeLwn(LwnMember* lwnMember) {
-        RedoLogRecord redoLogRecord[VECTOR_MAX_LENGTH];
-        uint64_t isUndoRedo[VECTOR_MAX_LENGTH];
+        RedoLogRecord *redoLogRecord = redoLogRecords + vectors;
+        OpCode **opCodesRecord = opCodes + vectors;
+        uint64_t vector = 0;
         uint64_t opCodesUndo[VECTOR_MAX_LENGTH / 2];
         uint64_t vectorsUndo = 0;
         uint64_t opCodesRedo[VECTOR_MAX_LENGTH / 2];
         uint64_t vectorsRedo = 0;
-        uint8_t *data = ((uint8_t *)lwnMember) + sizeof(struct LwnMember);
-
-        for (uint64_t i = 0; i < vectors; ++i) {
-            if (opCodes[i] != nullptr) {
-                delete opCodes[i];
-                opCodes[i] = nullptr;
-            }
-        }
-
-        vectors = 0;
-        memset(opCodes, 0, sizeof(opCodes));
+        uint8_t *data = lwnMember->data;
         uint64_t recordLength = oracleAnalyzer->read32(data);
         uint8_t vld = data[4];
         uint64_t headerLength;
@@ -352,26 +356,32 @@ namespace OpenLogReplicator {
 
         uint64_t pos = headerLength;
         while (pos < recordLength) {
-            memset(&redoLogRecord[vectors], 0, sizeof(struct RedoLogRecord));
-            redoLogRecord[vectors].vectorNo = vectors + 1;
-            redoLogRecord[vectors].cls = oracleAnalyzer->read16(data + pos + 2);
-            redoLogRecord[vectors].afn = oracleAnalyzer->read32(data + pos + 4) & 0xFFFF;
-            redoLogRecord[vectors].dba = oracleAnalyzer->read32(data + pos + 8);
-            redoLogRecord[vectors].scnRecord = oracleAnalyzer->readSCN(data + pos + 12);
-            redoLogRecord[vectors].rbl = 0; //FIXME
-            redoLogRecord[vectors].seq = data[pos + 20];
-            redoLogRecord[vectors].typ = data[pos + 21];
-            int16_t usn = (redoLogRecord[vectors].cls >= 15) ? (redoLogRecord[vectors].cls - 15) / 2 : -1;
+            if (vector == VECTOR_MAX_LENGTH) {
+                dumpRedoVector(data, recordLength);
+                REDOLOG_FAIL("block: " << dec << lwnMember->block << ", pos: " << lwnMember->pos <<
+                        ": too many vectors in record, max: " << dec << VECTOR_MAX_LENGTH);
+            }
+
+            memset(&redoLogRecord[vector], 0, sizeof(struct RedoLogRecord));
+            redoLogRecord[vector].vectorNo = vector + 1;
+            redoLogRecord[vector].cls = oracleAnalyzer->read16(data + pos + 2);
+            redoLogRecord[vector].afn = oracleAnalyzer->read32(data + pos + 4) & 0xFFFF;
+            redoLogRecord[vector].dba = oracleAnalyzer->read32(data + pos + 8);
+            redoLogRecord[vector].scnRecord = oracleAnalyzer->readSCN(data + pos + 12);
+            redoLogRecord[vector].rbl = 0; //FIXME
+            redoLogRecord[vector].seq = data[pos + 20];
+            redoLogRecord[vector].typ = data[pos + 21];
+            int16_t usn = (redoLogRecord[vector].cls >= 15) ? (redoLogRecord[vector].cls - 15) / 2 : -1;
 
             uint64_t fieldOffset;
             if (oracleAnalyzer->version >= 0x12100) {
                 fieldOffset = 32;
-                redoLogRecord[vectors].flgRecord = oracleAnalyzer->read16(data + pos + 28);
-                redoLogRecord[vectors].conId = oracleAnalyzer->read16(data + pos + 24);
+                redoLogRecord[vector].flgRecord = oracleAnalyzer->read16(data + pos + 28);
+                redoLogRecord[vector].conId = oracleAnalyzer->read16(data + pos + 24);
             } else {
                 fieldOffset = 24;
-                redoLogRecord[vectors].flgRecord = 0;
-                redoLogRecord[vectors].conId = 0;
+                redoLogRecord[vector].flgRecord = 0;
+                redoLogRecord[vector].conId = 0;
             }
 
             if (pos + fieldOffset + 1 >= recordLength) {
@@ -382,206 +392,278 @@ namespace OpenLogReplicator {
 
             uint8_t *fieldList = data + pos + fieldOffset;
 
-            redoLogRecord[vectors].opCode = (((typeop1)data[pos + 0]) << 8) |
+            redoLogRecord[vector].opCode = (((typeop1)data[pos + 0]) << 8) |
                     data[pos + 1];
-            redoLogRecord[vectors].length = fieldOffset + ((oracleAnalyzer->read16(fieldList) + 2) & 0xFFFC);
-            redoLogRecord[vectors].sequence = sequence;
-            redoLogRecord[vectors].scn = lwnMember->scn;
-            redoLogRecord[vectors].subScn = lwnMember->subScn;
-            redoLogRecord[vectors].usn = usn;
-            redoLogRecord[vectors].data = data + pos;
-            redoLogRecord[vectors].fieldLengthsDelta = fieldOffset;
-            redoLogRecord[vectors].fieldCnt = (oracleAnalyzer->read16(redoLogRecord[vectors].data + redoLogRecord[vectors].fieldLengthsDelta) - 2) / 2;
-            redoLogRecord[vectors].fieldPos = fieldOffset + ((oracleAnalyzer->read16(redoLogRecord[vectors].data + redoLogRecord[vectors].fieldLengthsDelta) + 2) & 0xFFFC);
-
-            uint64_t fieldPos = redoLogRecord[vectors].fieldPos;
-            for (uint64_t i = 1; i <= redoLogRecord[vectors].fieldCnt; ++i) {
-                redoLogRecord[vectors].length += (oracleAnalyzer->read16(fieldList + i * 2) + 3) & 0xFFFC;
-                fieldPos += (oracleAnalyzer->read16(redoLogRecord[vectors].data + redoLogRecord[vectors].fieldLengthsDelta + i * 2) + 3) & 0xFFFC;
-
-                if (pos + redoLogRecord[vectors].length > recordLength) {
+            redoLogRecord[vector].length = fieldOffset + ((oracleAnalyzer->read16(fieldList) + 2) & 0xFFFC);
+            redoLogRecord[vector].sequence = sequence;
+            redoLogRecord[vector].scn = lwnMember->scn;
+            redoLogRecord[vector].subScn = lwnMember->subScn;
+            redoLogRecord[vector].usn = usn;
+            redoLogRecord[vector].data = data + pos;
+            redoLogRecord[vector].lwnChunk = lwnMember->chunk;
+            redoLogRecord[vector].fieldLengthsDelta = fieldOffset;
+            redoLogRecord[vector].fieldCnt = (oracleAnalyzer->read16(redoLogRecord[vector].data + redoLogRecord[vector].fieldLengthsDelta) - 2) / 2;
+            redoLogRecord[vector].fieldPos = fieldOffset + ((oracleAnalyzer->read16(redoLogRecord[vector].data + redoLogRecord[vector].fieldLengthsDelta) + 2) & 0xFFFC);
+
+            uint64_t fieldPos = redoLogRecord[vector].fieldPos;
+            for (uint64_t i = 1; i <= redoLogRecord[vector].fieldCnt; ++i) {
+                redoLogRecord[vector].length += (oracleAnalyzer->read16(fieldList + i * 2) + 3) & 0xFFFC;
+                fieldPos += (oracleAnalyzer->read16(redoLogRecord[vector].data + redoLogRecord[vector].fieldLengthsDelta + i * 2) + 3) & 0xFFFC;
+
+                if (pos + redoLogRecord[vector].length > recordLength) {
                     dumpRedoVector(data, recordLength);
                     REDOLOG_FAIL("block: " << dec << lwnMember->block << ", pos: " << lwnMember->pos <<
                                         ": position of field list outside of record (" <<
                             "i: " << dec << i <<
-                            " c: " << dec << redoLogRecord[vectors].fieldCnt << " " <<
+                            " c: " << dec << redoLogRecord[vector].fieldCnt << " " <<
                             " o: " << dec << fieldOffset <<
                             " p: " << dec << pos <<
-                            " l: " << dec << redoLogRecord[vectors].length <<
+                            " l: " << dec << redoLogRecord[vector].length <<
                             " r: " << dec << recordLength << ")");
                 }
             }
 
-            if (redoLogRecord[vectors].fieldPos > redoLogRecord[vectors].length) {
+            if (redoLogRecord[vector].fieldPos > redoLogRecord[vector].length) {
                 dumpRedoVector(data, recordLength);
                 REDOLOG_FAIL("block: " << dec << lwnMember->block << ", pos: " << lwnMember->pos <<
-                                    ": incomplete record, pos: " << dec << redoLogRecord[vectors].fieldPos << ", length: " << redoLogRecord[vectors].length);
+                                    ": incomplete record, pos: " << dec << redoLogRecord[vector].fieldPos << ", length: " << redoLogRecord[vector].length);
             }
 
-            redoLogRecord[vectors].recordObjn = 0xFFFFFFFF;
-            redoLogRecord[vectors].recordObjd = 0xFFFFFFFF;
+            redoLogRecord[vector].recordObjn = 0xFFFFFFFF;
+            redoLogRecord[vector].recordObjd = 0xFFFFFFFF;
 
-            pos += redoLogRecord[vectors].length;
+            pos += redoLogRecord[vector].length;
 
-            switch (redoLogRecord[vectors].opCode) {
+            switch (redoLogRecord[vector].opCode) {
             case 0x0501: //Undo
-                opCodes[vectors] = new OpCode0501(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0501(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0501) << " bytes memory (for: OP 5.1)");
                 }
                 break;
 
             case 0x0502: //Begin transaction
-                opCodes[vectors] = new OpCode0502(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0502(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0502) << " bytes memory (for: OP 5.2)");
                 }
                 break;
 
             case 0x0504: //Commit/rollback transaction
-                opCodes[vectors] = new OpCode0504(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0504(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0504) << " bytes memory (for: OP 5.4)");
                 }
                 break;
 
             case 0x0506: //Partial rollback
-                opCodes[vectors] = new OpCode0506(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0506(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0506) << " bytes memory (for: OP 5.6)");
                 }
                 break;
 
             case 0x050B:
-                opCodes[vectors] = new OpCode050B(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode050B(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode050B) << " bytes memory (for: OP 5.11)");
                 }
                 break;
 
             case 0x0513: //Session information
-                opCodes[vectors] = new OpCode0513(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0513(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0513) << " bytes memory (for: OP 5.19)");
                 }
                 break;
 
             case 0x0514: //Session information
-                opCodes[vectors] = new OpCode0514(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0514(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0514) << " bytes memory (for: OP 5.20)");
                 }
                 break;
 
             case 0x0B02: //REDO: Insert row piece
-                opCodes[vectors] = new OpCode0B02(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0B02(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0B02) << " bytes memory (for: OP 11.2)");
                 }
                 break;
 
             case 0x0B03: //REDO: Delete row piece
-                opCodes[vectors] = new OpCode0B03(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0B03(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0B03) << " bytes memory (for: OP 11.3)");
                 }
                 break;
 
             case 0x0B04: //REDO: Lock row piece
-                opCodes[vectors] = new OpCode0B04(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0B04(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0B04) << " bytes memory (for: OP 11.4)");
                 }
                 break;
 
             case 0x0B05: //REDO: Update row piece
-                opCodes[vectors] = new OpCode0B05(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0B05(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0B05) << " bytes memory (for: OP 11.5)");
                 }
                 break;
 
             case 0x0B06: //REDO: Overwrite row piece
-                opCodes[vectors] = new OpCode0B06(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0B06(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0B06) << " bytes memory (for: OP 11.6)");
                 }
                 break;
 
             case 0x0B08: //REDO: Change forwarding address
-                opCodes[vectors] = new OpCode0B08(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0B08(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0B08) << " bytes memory (for: OP 11.8)");
                 }
                 break;
 
             case 0x0B0B: //REDO: Insert multiple rows
-                opCodes[vectors] = new OpCode0B0B(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0B0B(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0B0B) << " bytes memory (for: OP 11.11)");
                 }
                 break;
 
             case 0x0B0C: //REDO: Delete multiple rows
-                opCodes[vectors] = new OpCode0B0C(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0B0C(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0B0C) << " bytes memory (for: OP 11.12)");
                 }
                 break;
 
             case 0x0B10: //REDO: Supplemental log for update
-                opCodes[vectors] = new OpCode0B10(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode0B10(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0B10) << " bytes memory (for: OP 11.16)");
                 }
                 break;
 
             case 0x1801: //DDL
-                opCodes[vectors] = new OpCode1801(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode1801(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode1801) << " bytes memory (for: OP 24.1)");
                 }
                 break;
 
             default:
-                opCodes[vectors] = new OpCode(oracleAnalyzer, &redoLogRecord[vectors]);
-                if (opCodes[vectors] == nullptr) {
+                opCodesRecord[vector] = new OpCode(oracleAnalyzer, &redoLogRecord[vector]);
+                if (opCodesRecord[vector] == nullptr) {
                     RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode) << " bytes memory (for: OP)");
                 }
                 break;
             }
 
-            isUndoRedo[vectors] = 0;
             //UNDO
-            if (redoLogRecord[vectors].opCode == 0x0501
-                    || redoLogRecord[vectors].opCode == 0x0506
-                    || redoLogRecord[vectors].opCode == 0x050B) {
-                opCodesUndo[vectorsUndo++] = vectors;
-                isUndoRedo[vectors] = 1;
+            if (redoLogRecord[vector].opCode == 0x0501
+                    || redoLogRecord[vector].opCode == 0x0506
+                    || redoLogRecord[vector].opCode == 0x050B) {
+                opCodesUndo[vectorsUndo++] = vector;
                 if (vectorsUndo <= vectorsRedo) {
                     redoLogRecord[opCodesRedo[vectorsUndo - 1]].recordObjd = redoLogRecord[opCodesUndo[vectorsUndo - 1]].objd;
                     redoLogRecord[opCodesRedo[vectorsUndo - 1]].recordObjn = redoLogRecord[opCodesUndo[vectorsUndo - 1]].objn;
                 }
             //REDO
-            } else if ((redoLogRecord[vectors].opCode & 0xFF00) == 0x0A00 ||
-                    (redoLogRecord[vectors].opCode & 0xFF00) == 0x0B00) {
-                opCodesRedo[vectorsRedo++] = vectors;
-                isUndoRedo[vectors] = 2;
+            } else if ((redoLogRecord[vector].opCode & 0xFF00) == 0x0A00 ||
+                    (redoLogRecord[vector].opCode & 0xFF00) == 0x0B00) {
+                opCodesRedo[vectorsRedo++] = vector;
                 if (vectorsRedo <= vectorsUndo) {
                     redoLogRecord[opCodesRedo[vectorsRedo - 1]].recordObjd = redoLogRecord[opCodesUndo[vectorsRedo - 1]].objd;
                     redoLogRecord[opCodesRedo[vectorsRedo - 1]].recordObjn = redoLogRecord[opCodesUndo[vectorsRedo - 1]].objn;
                 }
             }
 
+            ++vector;
             ++vectors;
         }
 
+        if (vector == 0)
+            return;
+
+        lwnDecodeVectors[lwnDecodeRecords++] = vector;
+    }
+
+    void RedoLog::flushLwn(void) {
+        uint64_t decoded = oracleAnalyzer->decoderProcess(opCodes, vectors);
+        uint64_t vectorsNum = vectors;
+
         for (uint64_t i = 0; i < vectors; ++i) {
-            opCodes[i]->process();
             delete opCodes[i];
             opCodes[i] = nullptr;
         }
 
+        //transactions are appended sequentially in LWN order, records before the one which failed to decode are still appended
+        uint64_t first = 0;
+        for (uint64_t i = 0; i < lwnDecodeRecords; ++i) {
+            if (first + lwnDecodeVectors[i] > decoded)
+                break;
+            appendLwn(redoLogRecords + first, lwnDecodeVectors[i]);
+            first += lwnDecodeVectors[i];
+        }
+
+        vectors = 0;
+        lwnDecodeRecords = 0;
+
+        if (decoded < vectorsNum) {
+            REDOLOG_FAIL("decoding of LWN vectors failed");
+        }
+    }
+
+    //analyze of a record failed: drop its vectors and process records analyzed before it
+    void RedoLog::flushLwnAnalyzed(void) {
+        uint64_t analyzed = 0;
+        for (uint64_t i = 0; i < lwnDecodeRecords; ++i)
+            analyzed += lwnDecodeVectors[i];
+
+        for (uint64_t i = analyzed; i < vectors; ++i) {
+            delete opCodes[i];
+            opCodes[i] = nullptr;
+        }
+        vectors = analyzed;
+        flushLwn();
+    }
+
+    void RedoLog::appendLwn(RedoLogRecord *redoLogRecord, uint64_t vectors) {
+        uint64_t isUndoRedo[VECTOR_MAX_LENGTH];
+        uint64_t opCodesUndo[VECTOR_MAX_LENGTH / 2];
+        uint64_t vectorsUndo = 0;
+        uint64_t opCodesRedo[VECTOR_MAX_LENGTH / 2];
+        uint64_t vectorsRedo = 0;
+        RedoLogRecord *sessionRecord = nullptr;
+        typexid sessionXid = 0;
+
+        for (uint64_t i = 0; i < vectors; ++i) {
+            isUndoRedo[i] = 0;
+            //session information is matched with the transaction of the same redo record
+            if (oracleAnalyzer->skipSession) {
+                if (redoLogRecord[i].opCode == 0x0513 || redoLogRecord[i].opCode == 0x0514)
+                    sessionRecord = &redoLogRecord[i];
+                else if ((redoLogRecord[i].opCode == 0x0502 || redoLogRecord[i].opCode == 0x0501) && redoLogRecord[i].xid != 0)
+                    sessionXid = redoLogRecord[i].xid;
+            }
+
+            //UNDO
+            if (redoLogRecord[i].opCode == 0x0501
+                    || redoLogRecord[i].opCode == 0x0506
+                    || redoLogRecord[i].opCode == 0x050B) {
+                opCodesUndo[vectorsUndo++] = i;
+                isUndoRedo[i] = 1;
+            //REDO
+            } else if ((redoLogRecord[i].opCode & 0xFF00) == 0x0A00 ||
+                    (redoLogRecord[i].opCode & 0xFF00) == 0x0B00) {
+                opCodesRedo[vectorsRedo++] = i;
+                isUndoRedo[i] = 2;
+            }
+        }
+
         uint64_t iPair = 0;
         for (uint64_t i = 0; i < vectors; ++i) {
             //begin transaction
@@ -610,6 +692,20 @@ namespace OpenLogReplicator {
                 }
             }
         }
+
+        if (sessionRecord != nullptr && sessionXid != 0)
+            appendToTransactionSession(sessionRecord, sessionXid);
+    }
+
+    void RedoLog::freeLwnDecode(void) {
+        for (uint64_t i = 0; i < vectors; ++i) {
+            if (opCodes[i] != nullptr) {
+                delete opCodes[i];
+                opCodes[i] = nullptr;
+            }
+        }
+        vectors = 0;
+        lwnDecodeRecords = 0;
     }
 
     void RedoLog::appendToTransactionDDL(RedoLogRecord *redoLogRecord) {
@@ -627,18 +723,14 @@ namespace OpenLogReplicator {
         if (redoLogRecord->object == nullptr || redoLogRecord->object->options != 0)
             return;
 
-        Transaction *transaction = oracleAnalyzer->xidTransactionMap[redoLogRecord->xid >> 32];
+        Transaction *transaction = oracleAnalyzer->xidTransactionMap.find(redoLogRecord->xid >> 32);
         if (transaction == nullptr) {
             if ((oracleAnalyzer->flags & REDO_FLAGS_SHOW_INCOMPLETE_TRANSACTIONS) == 0) {
-                oracleAnalyzer->xidTransactionMap.erase(redoLogRecord->xid >> 32);
                 return;
             }
 
-            transaction = new Transaction(oracleAnalyzer, redoLogRecord->xid);
-            if (transaction == nullptr) {
-                RUNTIME_FAIL("couldn't allocate " << dec << sizeof(Transaction) << " bytes memory (for: append to transaction#1)");
-            }
-            oracleAnalyzer->xidTransactionMap[redoLogRecord->xid >> 32] = transaction;
+            transaction = oracleAnalyzer->transactionBuffer->newTransaction(redoLogRecord->xid);
+            oracleAnalyzer->xidTransactionMap.set(redoLogRecord->xid >> 32, transaction);
         } else {
             if (transaction->xid != redoLogRecord->xid) {
                 RUNTIME_FAIL("Transaction " << PRINTXID(redoLogRecord->xid) << " conflicts with " << PRINTXID(transaction->xid) << " #ddl");
@@ -657,18 +749,14 @@ namespace OpenLogReplicator {
         if (redoLogRecord->object == nullptr || redoLogRecord->object->options != 0)
             return;
 
-        Transaction *transaction = oracleAnalyzer->xidTransactionMap[redoLogRecord->xid >> 32];
+        Transaction *transaction = oracleAnalyzer->xidTransactionMap.find(redoLogRecord->xid >> 32);
         if (transaction == nullptr) {
             if ((oracleAnalyzer->flags & REDO_FLAGS_SHOW_INCOMPLETE_TRANSACTIONS) == 0) {
-                oracleAnalyzer->xidTransactionMap.erase(redoLogRecord->xid >> 32);
                 return;
             }
 
-            transaction = new Transaction(oracleAnalyzer, redoLogRecord->xid);
-            if (transaction == nullptr) {
-                RUNTIME_FAIL("couldn't allocate " << dec << sizeof(Transaction) << " bytes memory (for: append to transaction#2)");
-            }
-            oracleAnalyzer->xidTransactionMap[redoLogRecord->xid >> 32] = transaction;
+            transaction = oracleAnalyzer->transactionBuffer->newTransaction(redoLogRecord->xid);
+            oracleAnalyzer->xidTransactionMap.set(redoLogRecord->xid >> 32, transaction);
         } else {
             if (transaction->xid != redoLogRecord->xid) {
                 RUNTIME_FAIL("Transaction " << PRINTXID(redoLogRecord->xid) << " conflicts with " << PRINTXID(transaction->xid) << " #undo");
@@ -693,29 +781,27 @@ namespace OpenLogReplicator {
         if (SQN(redoLogRecord->xid) == 0)
             return;
 
-        Transaction *transaction = oracleAnalyzer->xidTransactionMap[redoLogRecord->xid >> 32];
+        Transaction *transaction = oracleAnalyzer->xidTransactionMap.find(redoLogRecord->xid >> 32);
         if (transaction != nullptr) {
             RUNTIME_FAIL("Transaction " << PRINTXID(redoLogRecord->xid) << " conflicts with " << PRINTXID(transaction->xid) << " #begin");
         }
 
-        transaction = new Transaction(oracleAnalyzer, redoLogRecord->xid);
-        if (transaction == nullptr) {
-            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(Transaction) << " bytes memory (for: begin transaction)");
-        }
-        oracleAnalyzer->xidTransactionMap[redoLogRecord->xid >> 32] = transaction;
+        transaction = oracleAnalyzer->transactionBuffer->newTransaction(redoLogRecord->xid);
+        oracleAnalyzer->xidTransactionMap.set(redoLogRecord->xid >> 32, transaction);
 
         transaction->isBegin = true;
         transaction->firstSequence = sequence;
         transaction->firstPos = lwnStartBlock * reader->blockSize;
+        transaction->firstScn = redoLogRecord->scn;
+        transaction->firstTime = lwnTimestamp;
     }
 
     void RedoLog::appendToTransactionCommit(RedoLogRecord *redoLogRecord) {
         TRACE(TRACE2_DUMP, *redoLogRecord);
 
-        Transaction *transaction = oracleAnalyzer->xidTransactionMap[redoLogRecord->xid >> 32];
+        Transaction *transaction = oracleAnalyzer->xidTransactionMap.find(redoLogRecord->xid >> 32);
         if (transaction == nullptr) {
             //unknown transaction
-            oracleAnalyzer->xidTransactionMap.erase(redoLogRecord->xid >> 32);
             return;
         }
         if (transaction->xid != redoLogRecord->xid) {
@@ -726,14 +812,21 @@ namespace OpenLogReplicator {
         transaction->commitScn = redoLogRecord->scnRecord; //maybe lwnScn?
         if ((redoLogRecord->flg & FLG_ROLLBACK_OP0504) != 0)
             transaction->isRollback = true;
+        transaction->applyRollback();
+        oracleAnalyzer->transactionStats->commit(transaction);
 
+        bool formatting = false;
         if (transaction->commitScn > oracleAnalyzer->scn) {
             if (transaction->shutdown) {
+                oracleAnalyzer->formatterDrain();
                 stopMain();
             } else {
-                if (transaction->isBegin)
-                    transaction->flush();
-                else {
+                if (transaction->isBegin) {
+                    //transaction is released after the formatter publishes its output
+                    formatting = oracleAnalyzer->formatterSubmit(transaction);
+                    if (!formatting)
+                        transaction->flush();
+                } else {
                     INFO("skipping transaction with no begin: " << *transaction);
                 }
             }
@@ -742,10 +835,71 @@ namespace OpenLogReplicator {
         }
 
         oracleAnalyzer->xidTransactionMap.erase(transaction->xid >> 32);
-        delete transaction;
+        if (!formatting)
+            oracleAnalyzer->transactionBuffer->deleteTransaction(transaction);
 
     }
 
+    void RedoLog::appendToTransactionSession(RedoLogRecord *redoLogRecord, typexid xid) {
+        TRACE(TRACE2_DUMP, *redoLogRecord);
+
+        Transaction *transaction = oracleAnalyzer->xidTransactionMap.find(xid >> 32);
+        if (transaction == nullptr || transaction->xid != xid || transaction->skip)
+            return;
+
+        uint64_t fieldNum = 0, fieldPos = 0;
+        uint16_t fieldLength = 0;
+
+        //field: 1 - session and serial number
+        oracleAnalyzer->nextField(redoLogRecord, fieldNum, fieldPos, fieldLength);
+
+        while (oracleAnalyzer->nextFieldOpt(redoLogRecord, fieldNum, fieldPos, fieldLength)) {
+            set<string> *filter = nullptr;
+            if (redoLogRecord->opCode == 0x0513) {
+                switch (fieldNum) {
+                case 2:     //current username
+                case 3:     //login username
+                    filter = &oracleAnalyzer->skipSessionUser;
+                    break;
+                case 4:     //client info
+                    filter = &oracleAnalyzer->skipSessionClientInfo;
+                    break;
+                case 9:     //OS program name
+                    filter = &oracleAnalyzer->skipSessionProgram;
+                    break;
+                case 10:    //transaction name
+                    filter = &oracleAnalyzer->skipSessionTransactionName;
+                    break;
+                case 14:    //client id
+                    filter = &oracleAnalyzer->skipSessionClientId;
+                    break;
+                }
+            } else {
+                switch (fieldNum) {
+                case 2:     //transaction name
+                    filter = &oracleAnalyzer->skipSessionTransactionName;
+                    break;
+                case 7:     //client id
+                    filter = &oracleAnalyzer->skipSessionClientId;
+                    break;
+                case 8:     //login username
+                    filter = &oracleAnalyzer->skipSessionUser;
+                    break;
+                }
+            }
+
+            if (filter == nullptr || filter->empty() || fieldLength == 0)
+                continue;
+
+            string value((const char*)(redoLogRecord->data + fieldPos), fieldLength);
+            if (filter->find(value) != filter->end()) {
+                TRACE(TRACE2_TRANSACTION, "skipping transaction " << PRINTXID(xid) << " by session attribute: " << value);
+                transaction->skipSession();
+                return;
+            }
+        }
+    }
+
     void RedoLog::appendToTransaction(RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2) {
         bool shutdown = false;
         TRACE(TRACE2_DUMP, *redoLogRecord1);
@@ -816,18 +970,14 @@ namespace OpenLogReplicator {
         //supp log for update
         case 0x05010B10:
             {
-                Transaction *transaction = oracleAnalyzer->xidTransactionMap[redoLogRecord1->xid >> 32];
+                Transaction *transaction = oracleAnalyzer->xidTransactionMap.find(redoLogRecord1->xid >> 32);
                 if (transaction == nullptr) {
                     if ((oracleAnalyzer->flags & REDO_FLAGS_SHOW_INCOMPLETE_TRANSACTIONS) == 0) {
-                        oracleAnalyzer->xidTransactionMap.erase(redoLogRecord1->xid >> 32);
                         return;
                     }
 
-                    transaction = new Transaction(oracleAnalyzer, redoLogRecord1->xid);
-                    if (transaction == nullptr) {
-                        RUNTIME_FAIL("couldn't allocate " << dec << sizeof(Transaction) << " bytes memory (for: append to transaction#3)");
-                    }
-                    oracleAnalyzer->xidTransactionMap[redoLogRecord1->xid >> 32] = transaction;
+                    transaction = oracleAnalyzer->transactionBuffer->newTransaction(redoLogRecord1->xid);
+                    oracleAnalyzer->xidTransactionMap.set(redoLogRecord1->xid >> 32, transaction);
                 } else {
                     if (transaction->xid != redoLogRecord1->xid) {
                         RUNTIME_FAIL("Transaction " << PRINTXID(redoLogRecord1->xid) << " conflicts with " << PRINTXID(transaction->xid) << " #append");
@@ -835,6 +985,9 @@ namespace OpenLogReplicator {
                 }
                 transaction->add(redoLogRecord1, redoLogRecord2);
                 transaction->shutdown = shutdown;
+
+                if (oracleAnalyzer->streamTransactionOps > 0 && transaction->opCodes >= oracleAnalyzer->streamTransactionOps)
+                    transaction->flushStream(lwnScn, lwnTimestamp);
             }
             break;
 
@@ -861,13 +1014,12 @@ namespace OpenLogReplicator {
         case 0x0B10050B:
             {
                 typeusnslt usnslt = (((uint32_t)redoLogRecord2->usn) << 16) | (redoLogRecord2->slt);
-                Transaction *transaction = oracleAnalyzer->xidTransactionMap[usnslt];
+                Transaction *transaction = oracleAnalyzer->xidTransactionMap.find(usnslt);
 
                 //match
                 if (transaction != nullptr) {
-                    transaction->rollbackLastOp(redoLogRecord1->scn);
+                    transaction->rollbackLastOp(redoLogRecord1->scn, lwnTimestamp);
                 } else {
-                    oracleAnalyzer->xidTransactionMap.erase(usnslt);
                     WARNING("no match found for transaction rollback, skipping");
                 }
             }
@@ -893,24 +1045,64 @@ namespace OpenLogReplicator {
         }
     }
 
+    uint8_t *RedoLog::lwnAlloc(uint64_t size) {
+        uint64_t *length = (uint64_t*)(lwnChunks[lwnAllocated - 1]);
+
+        if (*length + size > MEMORY_CHUNK_SIZE_MB * 1024 * 1024) {
+            if (lwnAllocated == MAX_LWN_CHUNKS) {
+                RUNTIME_FAIL("all " << dec << MAX_LWN_CHUNKS << " LWN buffers allocated");
+            }
+
+            lwnChunks[lwnAllocated++] = oracleAnalyzer->getMemoryChunk("LWN", false);
+            length = (uint64_t*)(lwnChunks[lwnAllocated - 1]);
+            length[0] = LWN_CHUNK_HEADER_SIZE;
+            length[1] = 1;
+        }
+
+        uint8_t *ptr = lwnChunks[lwnAllocated - 1] + *length;
+        *length += size;
+        return ptr;
+    }
+
+    void RedoLog::copyLwnMembers(void) {
+        for (uint64_t i = 0; i < lwnRecords; ++i) {
+            LwnMember *lwnMember = lwnMembers[i];
+            if (lwnMember->data == ((uint8_t*)lwnMember) + sizeof(struct LwnMember))
+                continue;
+
+            uint8_t *data = lwnAlloc(lwnMember->length);
+            memcpy(data, lwnMember->data, lwnMember->length);
+            lwnMember->data = data;
+            lwnMember->chunk = lwnChunks[lwnAllocated - 1];
+        }
+    }
+
+    void RedoLog::resetLwnChunks(void) {
+        //chunks with vector data retained by transactions are freed with the last transaction
+        uint8_t *chunk = lwnChunks[lwnAllocated - 1];
+        for (uint64_t i = 0; i < lwnAllocated - 1; ++i)
+            oracleAnalyzer->transactionBuffer->releaseLwnChunk(lwnChunks[i]);
+        lwnChunks[0] = chunk;
+        lwnAllocated = 1;
+
+        //not retained, can be reused from the beginning
+        uint64_t *length = (uint64_t *)chunk;
+        if (length[1] == 1)
+            length[0] = LWN_CHUNK_HEADER_SIZE;
+    }
+
     void RedoLog::resetRedo(void) {
         lwnConfirmedBlock = 2;
-
-        while (lwnAllocated > 1)
-            oracleAnalyzer->freeMemoryChunk("LWN", lwnChunks[--lwnAllocated], false);
-        uint64_t *length = (uint64_t *)lwnChunks[0];
-        *length = sizeof(uint64_t);
+        lwnRecords = 0;
+        resetLwnChunks();
     }
 
     void RedoLog::continueRedo(RedoLog *prev) {
         lwnConfirmedBlock = prev->lwnConfirmedBlock;
+        lwnRecords = 0;
         reader->bufferStart = prev->lwnConfirmedBlock * prev->reader->blockSize;
         reader->bufferEnd = prev->lwnConfirmedBlock * prev->reader->blockSize;
-
-        while (lwnAllocated > 1)
-            oracleAnalyzer->freeMemoryChunk("LWN", lwnChunks[--lwnAllocated], false);
-        uint64_t *length = (uint64_t *)lwnChunks[0];
-        *length = sizeof(uint64_t);
+        resetLwnChunks();
     }
 
     uint64_t RedoLog::processLog(void) {
@@ -919,6 +1111,15 @@ namespace OpenLogReplicator {
             nextScn = reader->nextScn;
         }
         INFO("processing redo log: " << *this);
+
+        //resume from position of restored transaction snapshot
+        TransactionSnapshot *transactionSnapshot = oracleAnalyzer->transactionSnapshot;
+        if (transactionSnapshot != nullptr && transactionSnapshot->block > 0 && transactionSnapshot->sequence == sequence) {
+            lwnConfirmedBlock = transactionSnapshot->block;
+            reader->bufferStart = transactionSnapshot->block * reader->blockSize;
+            reader->bufferEnd = transactionSnapshot->block * reader->blockSize;
+            transactionSnapshot->block = 0;
+        }
         uint64_t currentBlock = lwnConfirmedBlock, blockPos = 16, bufferPos = 0, startBlock = lwnConfirmedBlock;
         uint64_t curBufferStart = 0, curBufferEnd = 0, curRet, curStatus;
         LwnMember *lwnMember;
@@ -938,6 +1139,19 @@ namespace OpenLogReplicator {
             }
         }
 
+        if (opCodes == nullptr) {
+            opCodes = new OpCode*[LWN_DECODE_VECTORS];
+            if (opCodes == nullptr) {
+                RUNTIME_FAIL("couldn't allocate " << dec << (sizeof(OpCode*) * LWN_DECODE_VECTORS) << " bytes memory (for: LWN decode)");
+            }
+        }
+        if (redoLogRecords == nullptr) {
+            redoLogRecords = new RedoLogRecord[LWN_DECODE_VECTORS];
+            if (redoLogRecords == nullptr) {
+                RUNTIME_FAIL("couldn't allocate " << dec << (sizeof(RedoLogRecord) * LWN_DECODE_VECTORS) << " bytes memory (for: LWN decode)");
+            }
+        }
+
         clock_t cStart = clock();
         {
             unique_lock<mutex> lck(oracleAnalyzer->mtx);
@@ -948,7 +1162,8 @@ namespace OpenLogReplicator {
         }
         curBufferStart = reader->bufferStart;
         bufferPos = (currentBlock * reader->blockSize) % DISK_BUFFER_SIZE;
-        uint64_t recordLength4 = 0, recordPos = 0, recordLeftToCopy = 0, lwnEndBlock = lwnConfirmedBlock;
+        uint64_t recordLength4 = 0, recordPos = 0, recordLeftToCopy = 0, lwnEndBlock = lwnConfirmedBlock, lwnPinned = 0;
+        bool recordInPlace = false;
         uint16_t lwnNum = 0, lwnNumMax = 0;
         lwnStartBlock = lwnConfirmedBlock;
 
@@ -984,21 +1199,25 @@ namespace OpenLogReplicator {
                             break;
 
                         recordLength4 = (((uint64_t)oracleAnalyzer->read32(reader->redoBuffer + bufferPos + blockPos)) + 3) & 0xFFFFFFFC;
-                        if (recordLength4 > 0) {
-                            uint64_t *length = (uint64_t*)(lwnChunks[lwnAllocated - 1]);
-
-                            if (*length + sizeof(LwnMember) + recordLength4 > MEMORY_CHUNK_SIZE_MB * 1024 * 1024) {
-                                if (lwnAllocated == MAX_LWN_CHUNKS) {
-                                    RUNTIME_FAIL("all " << dec << MAX_LWN_CHUNKS << " LWN buffers allocated");
-                                }
+                        if (recordLength4 > MEMORY_CHUNK_SIZE_MB * 1024 * 1024 - sizeof(LwnMember) - LWN_CHUNK_HEADER_SIZE) {
+                            RUNTIME_FAIL("too big log record: " << dec << recordLength4 << " bytes");
+                        }
 
-                                lwnChunks[lwnAllocated++] = oracleAnalyzer->getMemoryChunk("LWN", false);
-                                length = (uint64_t*)(lwnChunks[lwnAllocated - 1]);
-                                *length = sizeof(uint64_t);
+                        if (recordLength4 > 0) {
+                            //record contained in one block is referenced directly in the reader buffer
+                            recordInPlace = (blockPos + recordLength4 <= reader->blockSize);
+                            if (recordInPlace) {
+                                lwnMember = (struct LwnMember*)lwnAlloc(sizeof(LwnMember));
+                                lwnMember->data = reader->redoBuffer + bufferPos + blockPos;
+                                lwnMember->chunk = nullptr;
+                                if (lwnPinned == 0)
+                                    lwnPinned = curBufferStart;
+                            } else {
+                                lwnMember = (struct LwnMember*)lwnAlloc(sizeof(LwnMember) + recordLength4);
+                                lwnMember->data = ((uint8_t*)lwnMember) + sizeof(struct LwnMember);
+                                lwnMember->chunk = lwnChunks[lwnAllocated - 1];
                             }
-
-                            lwnMember = (struct LwnMember*)(lwnChunks[lwnAllocated - 1] + *length);
-                            *length += sizeof(LwnMember) + recordLength4;
+                            lwnMember->length = recordLength4;
                             lwnMember->scn = oracleAnalyzer->read32(reader->redoBuffer + bufferPos + blockPos + 8) |
                                     ((uint64_t)(oracleAnalyzer->read16(reader->redoBuffer + bufferPos + blockPos + 6)) << 32);
                             lwnMember->subScn = oracleAnalyzer->read16(reader->redoBuffer + bufferPos + blockPos + 12);
@@ -1020,10 +1239,6 @@ namespace OpenLogReplicator {
                             lwnMembers[lwnPos] = lwnMember;
                         }
 
-                        if (recordLength4 > MEMORY_CHUNK_SIZE_MB * 1024 * 1024 - sizeof(LwnMember) - sizeof(uint64_t)) {
-                            RUNTIME_FAIL("too big log record: " << dec << recordLength4 << " bytes");
-                        }
-
                         recordLeftToCopy = recordLength4;
                         recordPos = 0;
                     }
@@ -1032,13 +1247,19 @@ namespace OpenLogReplicator {
                     if (recordLeftToCopy == 0)
                         break;
 
+                    if (recordInPlace) {
+                        blockPos += recordLeftToCopy;
+                        recordLeftToCopy = 0;
+                        continue;
+                    }
+
                     uint64_t toCopy;
                     if (blockPos + recordLeftToCopy > reader->blockSize)
                         toCopy = reader->blockSize - blockPos;
                     else
                         toCopy = recordLeftToCopy;
 
-                    memcpy(((uint8_t*)lwnMember) + sizeof(struct LwnMember) + recordPos, reader->redoBuffer + bufferPos + blockPos, toCopy);
+                    memcpy(lwnMember->data + recordPos, reader->redoBuffer + bufferPos + blockPos, toCopy);
                     recordLeftToCopy -= toCopy;
                     blockPos += toCopy;
                     recordPos += toCopy;
@@ -1053,22 +1274,35 @@ namespace OpenLogReplicator {
                         for (uint64_t i = 0; i < lwnRecords; ++i) {
                             TRACE(TRACE2_LWN, "LWN: analyze blk: " << dec << lwnMembers[i]->block << " pos: " << lwnMembers[i]->pos <<
                                     " scn: " << lwnMembers[i]->scn << " subscn: " << lwnMembers[i]->subScn);
-                            analyzeLwn(lwnMembers[i]);
+                            try {
+                                analyzeLwn(lwnMembers[i]);
+                            } catch(RedoLogException &ex) {
+                                flushLwnAnalyzed();
+                                throw;
+                            }
+
+                            //without decoder threads every record is processed at once
+                            if (oracleAnalyzer->decoders.size() == 0 || vectors + VECTOR_MAX_LENGTH > LWN_DECODE_VECTORS)
+                                flushLwn();
                         }
+                        flushLwn();
                     } catch(RedoLogException &ex) {
                         if ((oracleAnalyzer->flags & REDO_FLAGS_ON_ERROR_CONTINUE) == 0) {
                             RUNTIME_FAIL("runtime error, aborting further redo log processing");
                         } else
                             WARNING("forced to continue working in spite of error");
                     }
+                    freeLwnDecode();
 
-                    for (uint64_t i = 1; i < lwnAllocated; ++i)
-                        oracleAnalyzer->freeMemoryChunk("LWN", lwnChunks[i], false);
-                    lwnAllocated = 1;
-                    uint64_t *length = (uint64_t *)lwnChunks[0];
-                    *length = sizeof(uint64_t);
+                    resetLwnChunks();
                     lwnRecords = 0;
                     lwnConfirmedBlock = currentBlock;
+                    lwnPinned = 0;
+
+                    oracleAnalyzer->transactionStats->report(lwnTimestamp);
+                    if (oracleAnalyzer->transactionSnapshot != nullptr)
+                        oracleAnalyzer->transactionSnapshot->write(sequence, lwnConfirmedBlock, lwnScn);
+                    oracleAnalyzer->outputBuffer->processPoll();
                 }
 
                 curBufferStart += reader->blockSize;
@@ -1076,9 +1310,16 @@ namespace OpenLogReplicator {
                 if (bufferPos == DISK_BUFFER_SIZE)
                     bufferPos = 0;
 
-                if (curBufferStart - reader->bufferStart > DISK_BUFFER_SIZE / 16) {
+                //long LWN would block the reader - copy the records out of the reader buffer
+                if (lwnPinned != 0 && curBufferStart - lwnPinned > DISK_BUFFER_SIZE / 2) {
+                    copyLwnMembers();
+                    lwnPinned = 0;
+                }
+
+                uint64_t releaseStart = (lwnPinned != 0) ? lwnPinned : curBufferStart;
+                if (releaseStart > reader->bufferStart + DISK_BUFFER_SIZE / 16) {
                     unique_lock<mutex> lck(oracleAnalyzer->mtx);
-                    reader->bufferStart = curBufferStart;
+                    reader->bufferStart = releaseStart;
                     curBufferEnd = reader->bufferEnd;
                     if (reader->status == READER_STATUS_READ) {
                         oracleAnalyzer->readerCond.notify_all();
@@ -1086,13 +1327,15 @@ namespace OpenLogReplicator {
                 }
             }
 
+            bool idle = false;
             {
                 unique_lock<mutex> lck(oracleAnalyzer->mtx);
                 curBufferEnd = reader->bufferEnd;
                 curStatus = reader->status;
                 curRet = reader->ret;
-                if (reader->bufferStart < curBufferStart) {
-                    reader->bufferStart = curBufferStart;
+                uint64_t releaseStart = (lwnPinned != 0) ? lwnPinned : curBufferStart;
+                if (reader->bufferStart < releaseStart) {
+                    reader->bufferStart = releaseStart;
                     if (reader->status == READER_STATUS_READ) {
                         oracleAnalyzer->readerCond.notify_all();
                     }
@@ -1102,9 +1345,15 @@ namespace OpenLogReplicator {
                 if (curBufferStart == curBufferEnd) {
                     if (curRet == REDO_FINISHED || curRet == REDO_OVERWRITTEN || curStatus == READER_STATUS_SLEEPING)
                         break;
-                    oracleAnalyzer->analyzerCond.wait(lck);
+                    //timed wait, so buffered output is sent also when no new redo data arrives; new data wakes up earlier anyway
+                    uint64_t idleWait = (oracleAnalyzer->redoReadSleep > IDLE_WAIT_MIN_US) ? oracleAnalyzer->redoReadSleep : IDLE_WAIT_MIN_US;
+                    oracleAnalyzer->analyzerCond.wait_for(lck, chrono::microseconds(idleWait));
+                    idle = true;
                 }
             }
+
+            if (idle)
+                oracleAnalyzer->outputBuffer->processPoll();
         }
 
         clock_t cEnd = clock();
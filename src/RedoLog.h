@@ -27,6 +27,10 @@ using namespace std;
 
 #define VECTOR_MAX_LENGTH 512
 #define MAX_LWN_CHUNKS (256*2/MEMORY_CHUNK_SIZE_MB)
+//LWN chunk header: used length, reference count (redo log and transactions retaining vector data)
+#define LWN_CHUNK_HEADER_SIZE (sizeof(uint64_t)+sizeof(uint64_t))
+#define LWN_DECODE_VECTORS 8192
+#define IDLE_WAIT_MIN_US 1000
 
 namespace OpenLogReplicator {
 
@@ -39,14 +43,20 @@ namespace OpenLogReplicator {
         typesubscn subScn;
         typeblk block;
         uint64_t pos;
+        uint64_t length;
+        uint8_t *data;            //record data, in the reader buffer when it fits in one block
+        uint8_t *chunk;           //LWN chunk holding the data, nullptr for data in the reader buffer
     };
 
     class RedoLog {
     protected:
         OracleAnalyzer *oracleAnalyzer;
-        OpCode *opCodes[VECTOR_MAX_LENGTH];
+        OpCode **opCodes;
+        RedoLogRecord *redoLogRecords;
         RedoLogRecord zero;
         uint64_t vectors;
+        uint64_t lwnDecodeRecords;
+        uint64_t lwnDecodeVectors[LWN_DECODE_VECTORS];
         uint64_t lwnConfirmedBlock;
         uint8_t *lwnChunks[MAX_LWN_CHUNKS];
         uint64_t lwnAllocated;
@@ -57,11 +67,19 @@ namespace OpenLogReplicator {
         uint64_t lwnStartBlock;
 
         void printHeaderInfo(void);
+        uint8_t *lwnAlloc(uint64_t size);
+        void resetLwnChunks(void);
+        void copyLwnMembers(void);
         void analyzeLwn(LwnMember* lwnMember);
+        void flushLwn(void);
+        void flushLwnAnalyzed(void);
+        void appendLwn(RedoLogRecord *redoLogRecord, uint64_t vectors);
+        void freeLwnDecode(void);
         void appendToTransactionDDL(RedoLogRecord *redoLogRecord);
         void appendToTransactionUndo(RedoLogRecord *redoLogRecord);
         void appendToTransactionBegin(RedoLogRecord *redoLogRecord);
         void appendToTransactionCommit(RedoLogRecord *redoLogRecord);
+        void appendToTransactionSession(RedoLogRecord *redoLogRecord, typexid xid);
         void appendToTransaction(RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2);
         void dumpRedoVector(uint8_t *data, uint64_t recordLength4);
 
@@ -0,0 +1,86 @@
+/* Thread decoding redo log vectors in parallel
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <thread>
+
+#include "OpCode.h"
+#include "OracleAnalyzer.h"
+#include "RedoLogDecoder.h"
+#include "RedoLogException.h"
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    RedoLogDecoder::RedoLogDecoder(const char *alias, OracleAnalyzer *oracleAnalyzer, uint64_t id) :
+        Thread(alias),
+        oracleAnalyzer(oracleAnalyzer),
+        id(id) {
+    }
+
+    RedoLogDecoder::~RedoLogDecoder() {
+    }
+
+    //returns index of the vector which failed to decode, decoderOpCodesNum when the whole slice is decoded
+    uint64_t RedoLogDecoder::processSlice(OracleAnalyzer *oracleAnalyzer, uint64_t id) {
+        //the calling analyzer thread takes the last slice
+        uint64_t slices = oracleAnalyzer->decoders.size() + 1;
+        uint64_t first = oracleAnalyzer->decoderOpCodesNum * id / slices;
+        uint64_t last = oracleAnalyzer->decoderOpCodesNum * (id + 1) / slices;
+
+        for (uint64_t i = first; i < last; ++i) {
+            try {
+                oracleAnalyzer->decoderOpCodes[i]->process();
+            } catch(RedoLogException &ex) {
+                return i;
+            }
+        }
+        return oracleAnalyzer->decoderOpCodesNum;
+    }
+
+    void *RedoLogDecoder::run(void) {
+        TRACE(TRACE2_THREADS, "DECODER (" << hex << this_thread::get_id() << ") START");
+        uint64_t batch = 0;
+
+        while (!shutdown) {
+            {
+                unique_lock<mutex> lck(oracleAnalyzer->decoderMtx);
+                while (oracleAnalyzer->decoderBatch == batch && !shutdown)
+                    oracleAnalyzer->decoderCond.wait(lck);
+                batch = oracleAnalyzer->decoderBatch;
+            }
+
+            if (shutdown)
+                break;
+
+            uint64_t decoded = processSlice(oracleAnalyzer, id);
+
+            {
+                unique_lock<mutex> lck(oracleAnalyzer->decoderMtx);
+                if (decoded < oracleAnalyzer->decoderFailedVector)
+                    oracleAnalyzer->decoderFailedVector = decoded;
+                if (--oracleAnalyzer->decoderRunning == 0)
+                    oracleAnalyzer->decoderDoneCond.notify_all();
+            }
+        }
+
+        TRACE(TRACE2_THREADS, "DECODER (" << hex << this_thread::get_id() << ") STOP");
+        return 0;
+    }
+}
@@ -0,0 +1,49 @@
+/* Header for RedoLogDecoder class
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include "Thread.h"
+
+#ifndef REDOLOGDECODER_H_
+#define REDOLOGDECODER_H_
+
+#define MAX_DECODER_THREADS     64
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    class OracleAnalyzer;
+
+    //worker decoding (OpCode::process) a slice of vectors of a completed LWN
+    class RedoLogDecoder : public Thread {
+    protected:
+        OracleAnalyzer *oracleAnalyzer;
+        uint64_t id;
+
+        virtual void *run(void);
+
+    public:
+        RedoLogDecoder(const char *alias, OracleAnalyzer *oracleAnalyzer, uint64_t id);
+        virtual ~RedoLogDecoder();
+
+        static uint64_t processSlice(OracleAnalyzer *oracleAnalyzer, uint64_t id);
+    };
+}
+
+#endif
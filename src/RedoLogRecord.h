@@ -111,6 +111,7 @@ namespace OpenLogReplicator {
         typescn scn;              //scn
         typesubscn subScn;        //subscn
         uint8_t *data;            //data
+        uint8_t *lwnChunk;        //LWN chunk holding data which can be retained by transaction
         uint16_t fieldCnt;
         uint64_t fieldPos;
         uint64_t rowData;
@@ -0,0 +1,87 @@
+/* Header for Ryu class
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+The algorithm and tables are ported from Ryu (https://github.com/ulfjack/ryu):
+
+   Copyright 2018 Ulf Adams
+
+   The contents of this file may be used under the terms of the Apache
+   License, Version 2.0 (see <http://www.apache.org/licenses/LICENSE-2.0>).
+
+   Alternatively, the contents of this file may be used under the terms of
+   the Boost Software License, Version 1.0, reproduced below.
+
+   Unless required by applicable law or agreed to in writing, this software
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+
+   Boost Software License - Version 1.0 - August 17th, 2003
+
+   Permission is hereby granted, free of charge, to any person or organization
+   obtaining a copy of the software and accompanying documentation covered by
+   this license (the "Software") to use, reproduce, display, distribute,
+   execute, and transmit the Software, and to prepare derivative works of the
+   Software, and to permit third-parties to whom the Software is furnished to
+   do so, all subject to the following:
+
+   The copyright notices in the Software and this entire statement, including
+   the above license grant, this restriction and the following disclaimer,
+   must be included in all copies of the Software, in whole or in part, and
+   all derivative works of the Software, unless such copies or derivative
+   works are solely in the form of machine-executable object code generated by
+   a source language processor.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+   SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+   FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+
+Changes made for OpenLogReplicator (class layout, naming, integration with
+the output formats) are free software; you can redistribute them and/or
+modify them under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include "types.h"
+
+#ifndef RYU_H_
+#define RYU_H_
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    //shortest round-trip decimal representation of binary floating point values
+    //algorithm: Ulf Adams, "Ryu: fast float-to-string conversion", PLDI 2018
+    class Ryu {
+    protected:
+        static const uint64_t doublePow5InvSplit[342][2];
+        static const uint64_t doublePow5Split[326][2];
+        static const uint64_t floatPow5InvSplit[31];
+        static const uint64_t floatPow5Split[47];
+
+        static uint64_t mulShift64(uint64_t m, const uint64_t *mul, int32_t j);
+        static uint32_t mulShift32(uint32_t m, uint64_t factor, int32_t shift);
+
+    public:
+        //value must be finite and not zero; result is mantissa * 10^exponent
+        static void doubleToDecimal(double value, uint64_t &mantissa, int32_t &exponent);
+        static void floatToDecimal(float value, uint32_t &mantissa, int32_t &exponent);
+    };
+}
+
+#endif
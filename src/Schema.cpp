@@ -23,6 +23,7 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "OracleAnalyzer.h"
 #include "OracleColumn.h"
 #include "OracleObject.h"
+#include "OutputBuffer.h"
 #include "Reader.h"
 #include "RuntimeException.h"
 #include "Schema.h"
@@ -265,6 +266,7 @@ namespace OpenLogReplicator {
             }
 
             object->updatePK();
+            oracleAnalyzer->outputBuffer->updateDecodePlan(object);
             addToDict(object);
             object = nullptr;
         }
@@ -22,10 +22,23 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "OutputBuffer.h"
 #include "RedoLogRecord.h"
 #include "RuntimeException.h"
+#include "Schema.h"
 #include "Transaction.h"
 #include "TransactionBuffer.h"
+#include "TransactionStats.h"
 #include "Writer.h"
 
+//fields of RedoLogRecord stored in snapshot, pointers are rebuilt on read
+#define SNAPSHOT_RECORD_FIELDS(F) \
+    F(cls) F(scnRecord) F(rbl) F(seq) F(typ) F(conId) F(flgRecord) F(vectorNo) F(recordObjn) F(recordObjd) \
+    F(sequence) F(scn) F(subScn) F(fieldCnt) F(fieldPos) F(rowData) F(nrow) F(slotsDelta) F(rowLenghsDelta) \
+    F(fieldLengthsDelta) F(nullsDelta) F(colNumsDelta) F(afn) F(length) F(dba) F(bdba) F(objn) F(objd) F(tsn) \
+    F(undo) F(usn) F(xid) F(uba) F(pdbId) F(slt) F(rci) F(flg) F(opCode) F(opc) F(op) F(cc) F(itli) F(slot) \
+    F(flags) F(fb) F(tabn) F(nridBdba) F(nridSlot) F(suppLogType) F(suppLogFb) F(suppLogCC) F(suppLogBefore) \
+    F(suppLogAfter) F(suppLogBdba) F(suppLogSlot) F(suppLogRowData) F(suppLogNumsDelta) F(suppLogLenDelta) F(opFlags)
+#define SNAPSHOT_WRITE_FIELD(field) os.write((const char*)&redoLogRecord->field, sizeof(redoLogRecord->field));
+#define SNAPSHOT_READ_FIELD(field) is.read((char*)&redoLogRecord->field, sizeof(redoLogRecord->field));
+
 using namespace std;
 
 namespace OpenLogReplicator {
@@ -33,17 +46,26 @@ namespace OpenLogReplicator {
     Transaction::Transaction(OracleAnalyzer *oracleAnalyzer, typexid xid) :
             oracleAnalyzer(oracleAnalyzer),
             xid(xid),
-            firstSequence(0),
-            firstPos(0),
-            commitScn(0),
             firstTc(nullptr),
             lastTc(nullptr),
             opCodes(0),
+            streamedOps(0),
+            rollbackOps(0),
+            revertOps(0),
+            revertScn(0),
+            revertTime(0),
+            firstSequence(0),
+            firstPos(0),
+            commitScn(0),
+            firstScn(0),
+            firstTime(0),
             pos(0),
             commitTimestamp(0),
             isBegin(false),
             isRollback(false),
-            shutdown(false) {
+            shutdown(false),
+            skip(false),
+            lwnCopy(false) {
     }
 
     Transaction::~Transaction() {
@@ -55,6 +77,8 @@ namespace OpenLogReplicator {
         for (uint8_t* buf : merges)
             delete[] buf;
         merges.clear();
+
+        oracleAnalyzer->transactionBuffer->releaseLwnChunks(this);
     }
 
     void Transaction::mergeBlocks(uint8_t *buffer, RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2) {
@@ -96,290 +120,679 @@ namespace OpenLogReplicator {
     }
 
     void Transaction::add(RedoLogRecord *redoLogRecord) {
+        if (skip)
+            return;
+        applyRollback();
         oracleAnalyzer->transactionBuffer->addTransactionChunk(this, redoLogRecord);
         ++opCodes;
     }
 
     void Transaction::add(RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2) {
+        if (skip)
+            return;
+        applyRollback();
         oracleAnalyzer->transactionBuffer->addTransactionChunk(this, redoLogRecord1, redoLogRecord2);
         ++opCodes;
     }
 
-    void Transaction::rollbackLastOp(typescn scn) {
-        oracleAnalyzer->transactionBuffer->rollbackTransactionChunk(this);
+    void Transaction::rollbackLastOp(typescn scn, typetime time) {
+        if (skip)
+            return;
+        oracleAnalyzer->transactionStats->rollbackOp();
+
+        //operation already sent as provisional message is reverted by compensating one
+        if (opCodes == 0) {
+            if (streamedOps > 0) {
+                if (rollbackOps > 0) {
+                    oracleAnalyzer->transactionBuffer->rollbackTransactionChunks(this, rollbackOps);
+                    rollbackOps = 0;
+                }
+                ++revertOps;
+                --streamedOps;
+                revertScn = scn;
+                revertTime = time;
+                revertStreamed(false);
+            }
+            return;
+        }
+
+        //rollback to savepoint comes as a series of undo vectors, rows are removed together when needed
+        ++rollbackOps;
         --opCodes;
     }
 
+    void Transaction::applyRollback(void) {
+        if (rollbackOps > 0) {
+            oracleAnalyzer->transactionBuffer->rollbackTransactionChunks(this, rollbackOps);
+            rollbackOps = 0;
+        }
+
+        if (revertOps > 0)
+            revertStreamed(true);
+    }
+
+    //rows of operation are reverted together, after rollback of its first row
+    void Transaction::revertStreamed(bool force) {
+        if (!force) {
+            TransactionChunk *tc = lastTc;
+            uint64_t index = tc->elements, pos = tc->size;
+            for (uint64_t i = 0; i < revertOps; ++i) {
+                while (index == 0) {
+                    tc = tc->prev;
+                    if (tc == nullptr) {
+                        RUNTIME_FAIL("trying to revert " << dec << revertOps << " operations of transaction " << PRINTXID(xid) << " with less rows");
+                    }
+                    index = tc->elements;
+                    pos = tc->size;
+                }
+                pos -= *((uint64_t *)(tc->buffer + pos - ROW_HEADER_TOTAL + ROW_HEADER_SIZE));
+                --index;
+            }
+            if (!opStart(tc, index, pos))
+                return;
+        }
+
+        if (revertScn > oracleAnalyzer->scn) {
+            TRACE(TRACE2_TRANSACTION, "reverting " << dec << revertOps << " streamed operations of: " << *this);
+            oracleAnalyzer->formatterDrain();
+            oracleAnalyzer->outputBuffer->provisional = true;
+            oracleAnalyzer->outputBuffer->processBegin(revertScn, revertTime, xid);
+            flushRevert(oracleAnalyzer->outputBuffer, revertOps, revertScn, revertTime);
+            oracleAnalyzer->outputBuffer->processCommit();
+            oracleAnalyzer->outputBuffer->provisional = false;
+        }
+
+        oracleAnalyzer->transactionBuffer->rollbackTransactionChunks(this, revertOps);
+        revertOps = 0;
+    }
+
+    void Transaction::skipSession(void) {
+        applyRollback();
+        skip = true;
+
+        //rows already sent as provisional messages are reverted at commit
+        if (streamedOps > 0) {
+            oracleAnalyzer->transactionBuffer->rollbackTransactionChunks(this, opCodes);
+            opCodes = 0;
+            return;
+        }
+        opCodes = 0;
+
+        //no row references retained LWN chunks any more
+        if (firstTc != nullptr) {
+            oracleAnalyzer->transactionBuffer->deleteTransactionChunks(firstTc);
+            firstTc = nullptr;
+            lastTc = nullptr;
+        }
+        for (uint8_t* buf : merges)
+            delete[] buf;
+        merges.clear();
+        oracleAnalyzer->transactionBuffer->releaseLwnChunks(this);
+    }
+
+    //bytes include vector data of rows kept in retained LWN chunks
+    void Transaction::getSize(uint64_t &chunks, uint64_t &bytes, uint64_t &lwnBytes) const {
+        chunks = 0;
+        bytes = 0;
+        lwnBytes = 0;
+        for (TransactionChunk *tc = firstTc; tc != nullptr; tc = tc->next) {
+            ++chunks;
+            bytes += tc->size;
+
+            uint64_t pos = 0;
+            for (uint64_t i = 0; i < tc->elements; ++i) {
+                RedoLogRecord *redoLogRecord1 = ((RedoLogRecord *)(tc->buffer + pos + ROW_HEADER_REDO1)),
+                              *redoLogRecord2 = ((RedoLogRecord *)(tc->buffer + pos + ROW_HEADER_REDO2));
+                if (redoLogRecord1->lwnChunk == nullptr)
+                    pos += redoLogRecord1->length + redoLogRecord2->length + ROW_HEADER_TOTAL;
+                else {
+                    lwnBytes += redoLogRecord1->length + redoLogRecord2->length;
+                    pos += ROW_HEADER_TOTAL;
+                }
+            }
+        }
+        bytes += lwnBytes;
+    }
+
     void Transaction::flush(void) {
-        bool opFlush = false;
-        TransactionChunk *deallocTc = nullptr;
+        applyRollback();
 
-        if (opCodes > 0 && !isRollback) {
+        //rows already sent as provisional messages are withdrawn by rollback marker
+        if (isRollback) {
+            if (streamedOps > 0)
+                oracleAnalyzer->outputBuffer->processRollback(commitScn, commitTimestamp, xid);
+            return;
+        }
+
+        //committed, rows already sent as provisional messages are reverted by compensating operations
+        if (skip) {
+            if (streamedOps > 0) {
+                WARNING("transaction " << PRINTXID(xid) << " skipped by session attribute after " << dec << streamedOps <<
+                        " operations were streamed, sending compensating operations");
+                oracleAnalyzer->outputBuffer->processBegin(commitScn, commitTimestamp, xid);
+                flushRevert(oracleAnalyzer->outputBuffer, streamedOps, commitScn, commitTimestamp);
+                oracleAnalyzer->outputBuffer->processCommit();
+            }
+            return;
+        }
+
+        if (opCodes > 0 || streamedOps > 0) {
             TRACE(TRACE2_TRANSACTION, *this);
 
+            //rows already sent as provisional messages are not repeated
+            uint64_t index = streamedOps;
+            while (firstTc != nullptr && index >= firstTc->elements) {
+                index -= firstTc->elements;
+                TransactionChunk *nextTc = firstTc->next;
+                oracleAnalyzer->transactionBuffer->deleteTransactionChunk(firstTc);
+                firstTc = nextTc;
+                if (firstTc != nullptr)
+                    firstTc->prev = nullptr;
+            }
+
             oracleAnalyzer->outputBuffer->processBegin(commitScn, commitTimestamp, xid);
-            uint64_t pos, type = 0;
-            RedoLogRecord *first1 = nullptr, *first2 = nullptr, *last1 = nullptr, *last2 = nullptr, *last501 = nullptr;
+            flushChunks(oracleAnalyzer->outputBuffer, firstTc, index, opCodes, commitScn, commitTimestamp, true);
+            lastTc = nullptr;
+            opCodes = 0;
+            streamedOps = 0;
 
-            TransactionChunk *tc = firstTc;
-            while (tc != nullptr) {
-                pos = 0;
-                for (uint64_t i = 0; i < tc->elements; ++i) {
-                    typeop2 op = *((typeop2*)(tc->buffer + pos));
+            oracleAnalyzer->outputBuffer->processCommit();
+        }
+    }
+
+    void Transaction::format(OutputBuffer *outputBuffer) {
+        TRACE(TRACE2_TRANSACTION, *this);
+
+        outputBuffer->processBegin(commitScn, commitTimestamp, xid);
+        flushChunks(outputBuffer, firstTc, 0, opCodes, commitScn, commitTimestamp, false);
+        outputBuffer->processCommit();
+    }
+
+    void Transaction::flushStream(typescn scn, typetime time) {
+        applyRollback();
+
+        //the last chunk stays buffered, rollback of the last operation is still possible
+        if (!isBegin || shutdown || lastTc == nullptr || lastTc->prev == nullptr || scn <= oracleAnalyzer->scn)
+            return;
+
+        //stream only up to a complete row
+        if (!opStart(lastTc, 0, 0))
+            return;
+
+        uint64_t ops = 0;
+        for (TransactionChunk *tc = firstTc; tc != lastTc; tc = tc->next)
+            ops += tc->elements;
+        if (ops <= streamedOps)
+            return;
+        ops -= streamedOps;
+
+        //streamed rows stay buffered until commit, rollback to savepoint may still revert them
+        TransactionChunk *tc = firstTc;
+        uint64_t index = streamedOps;
+        while (index >= tc->elements) {
+            index -= tc->elements;
+            tc = tc->next;
+        }
+
+        TRACE(TRACE2_TRANSACTION, "streaming " << dec << ops << " operations of: " << *this);
+        oracleAnalyzer->formatterDrain();
+        oracleAnalyzer->outputBuffer->provisional = true;
+        oracleAnalyzer->outputBuffer->processBegin(scn, time, xid);
+        flushChunks(oracleAnalyzer->outputBuffer, tc, index, ops, scn, time, false);
+        oracleAnalyzer->outputBuffer->processCommit();
+        oracleAnalyzer->outputBuffer->provisional = false;
+
+        opCodes -= ops;
+        streamedOps += ops;
+    }
+
+    //last rows of the buffer are reverted last operation first, each one with images swapped
+    void Transaction::flushRevert(OutputBuffer *outputBuffer, uint64_t ops, typescn scn, typetime time) {
+        TransactionChunk *tc = lastTc;
+        uint64_t index = tc->elements, pos = tc->size, count = 0;
+
+        outputBuffer->compensate = true;
+        for (; ops > 0; --ops) {
+            while (index == 0) {
+                tc = tc->prev;
+                if (tc == nullptr) {
+                    RUNTIME_FAIL("trying to revert operations of transaction " << PRINTXID(xid) << " from empty buffer");
+                }
+                index = tc->elements;
+                pos = tc->size;
+            }
+            pos -= *((uint64_t *)(tc->buffer + pos - ROW_HEADER_TOTAL + ROW_HEADER_SIZE));
+            --index;
+            ++count;
+
+            if (ops == 1 || opStart(tc, index, pos)) {
+                flushChunks(outputBuffer, tc, index, count, scn, time, false);
+                count = 0;
+            }
+        }
+        outputBuffer->compensate = false;
+    }
 
-                    RedoLogRecord *redoLogRecord1 = ((RedoLogRecord *)(tc->buffer + pos + ROW_HEADER_REDO1)),
-                                  *redoLogRecord2 = ((RedoLogRecord *)(tc->buffer + pos + ROW_HEADER_REDO2));
+    //row at given position begins an operation when the row before completes one
+    bool Transaction::opStart(TransactionChunk *tc, uint64_t index, uint64_t pos) const {
+        if (index == 0) {
+            tc = tc->prev;
+            if (tc == nullptr)
+                return true;
+            pos = tc->size;
+        }
+
+        uint64_t lastSize = *((uint64_t *)(tc->buffer + pos - ROW_HEADER_TOTAL + ROW_HEADER_SIZE));
+        typeop2 op = *((typeop2*)(tc->buffer + pos - lastSize + ROW_HEADER_OP));
+        RedoLogRecord *redoLogRecord1 = ((RedoLogRecord *)(tc->buffer + pos - lastSize + ROW_HEADER_REDO1));
+        if ((redoLogRecord1->flg & (FLG_MULTIBLOCKUNDOMID | FLG_MULTIBLOCKUNDOTAIL)) != 0)
+            return false;
+        return op == 0x05010B0B || op == 0x05010B0C || op == 0x18010000 || (redoLogRecord1->suppLogFb & FB_L) != 0;
+    }
+
+    void Transaction::flushChunks(OutputBuffer *outputBuffer, TransactionChunk *tc, uint64_t index, uint64_t ops, typescn scn, typetime time, bool release) {
+        bool opFlush = false;
+        TransactionChunk *deallocTc = nullptr;
+        uint64_t pos, type = 0;
+        RedoLogRecord *first1 = nullptr, *first2 = nullptr, *last1 = nullptr, *last2 = nullptr, *last501 = nullptr;
+
+        while (tc != nullptr && ops > 0) {
+            pos = 0;
+            for (uint64_t i = 0; i < tc->elements && ops > 0; ++i) {
+                typeop2 op = *((typeop2*)(tc->buffer + pos));
+
+                RedoLogRecord *redoLogRecord1 = ((RedoLogRecord *)(tc->buffer + pos + ROW_HEADER_REDO1)),
+                              *redoLogRecord2 = ((RedoLogRecord *)(tc->buffer + pos + ROW_HEADER_REDO2));
+                //data of retained rows stays in the LWN chunk
+                if (redoLogRecord1->lwnChunk == nullptr) {
                     redoLogRecord1->data = tc->buffer + pos + ROW_HEADER_DATA;
                     redoLogRecord2->data = tc->buffer + pos + ROW_HEADER_DATA + redoLogRecord1->length;
                     pos += redoLogRecord1->length + redoLogRecord2->length + ROW_HEADER_TOTAL;
+                } else
+                    pos += ROW_HEADER_TOTAL;
+
+                if (i < index)
+                    continue;
+                --ops;
+
+                TRACE(TRACE2_TRANSACTION, "Row: " << setfill(' ') << setw(4) << dec << redoLogRecord1->length <<
+                                    ":" << setfill(' ') << setw(4) << dec << redoLogRecord2->length <<
+                                " fb: " << setfill('0') << setw(2) << hex << (uint64_t)redoLogRecord1->fb <<
+                                    ":" << setfill('0') << setw(2) << hex << (uint64_t)redoLogRecord2->fb << " " <<
+                                " op: " << setfill('0') << setw(8) << hex << op <<
+                                " scn: " << dec << redoLogRecord1->scn <<
+                                " subScn: " << dec << redoLogRecord1->subScn <<
+                                " scnRecord: " << dec << redoLogRecord1->scnRecord <<
+                                " objn: " << dec << redoLogRecord1->objn <<
+                                " objd: " << dec << redoLogRecord1->objd <<
+                                " flg1: 0x" << setfill('0') << setw(4) << hex << redoLogRecord1->flg <<
+                                " flg2: 0x" << setfill('0') << setw(4) << hex << redoLogRecord2->flg <<
+                                " uba1: " << PRINTUBA(redoLogRecord1->uba) <<
+                                " uba2: " << PRINTUBA(redoLogRecord2->uba) <<
+                                " bdba1: 0x" << setfill('0') << setw(8) << hex << redoLogRecord1->bdba << "." << hex << (uint64_t)redoLogRecord1->slot <<
+                                " nrid1: 0x" << setfill('0') << setw(8) << hex << redoLogRecord1->nridBdba << "." << hex << redoLogRecord1->nridSlot <<
+                                " bdba2: 0x" << setfill('0') << setw(8) << hex << redoLogRecord2->bdba << "." << hex << (uint64_t)redoLogRecord2->slot <<
+                                " nrid2: 0x" << setfill('0') << setw(8) << hex << redoLogRecord2->nridBdba << "." << hex << redoLogRecord2->nridSlot <<
+                                " supp: (0x" << setfill('0') << setw(2) << hex << (uint64_t)redoLogRecord1->suppLogFb <<
+                                    ", " << setfill(' ') << setw(3) << dec << (uint64_t)redoLogRecord1->suppLogType <<
+                                    ", " << setfill(' ') << setw(3) << dec << redoLogRecord1->suppLogCC <<
+                                    ", " << setfill(' ') << setw(3) << dec << redoLogRecord1->suppLogBefore <<
+                                    ", " << setfill(' ') << setw(3) << dec << redoLogRecord1->suppLogAfter <<
+                                    ", 0x" << setfill('0') << setw(8) << hex << redoLogRecord1->suppLogBdba << "." << hex << redoLogRecord1->suppLogSlot << ")");
+
+                //split undo is merged in copies, rows may be formatted again when reverted
+                if ((redoLogRecord1->flg & (FLG_MULTIBLOCKUNDOHEAD | FLG_MULTIBLOCKUNDOMID | FLG_MULTIBLOCKUNDOTAIL)) != 0) {
+                    uint64_t size = sizeof(struct RedoLogRecord) + redoLogRecord1->length;
+                    uint8_t *copy = new uint8_t[size];
+                    if (copy == nullptr) {
+                        RUNTIME_FAIL("couldn't allocate " << dec << size << " bytes memory (for: split undo copy)");
+                    }
+                    merges.push_back(copy);
+                    memcpy(copy, redoLogRecord1, sizeof(struct RedoLogRecord));
+                    memcpy(copy + sizeof(struct RedoLogRecord), redoLogRecord1->data, redoLogRecord1->length);
+                    redoLogRecord1 = (RedoLogRecord *)copy;
+                    redoLogRecord1->data = copy + sizeof(struct RedoLogRecord);
+                }
 
-                    TRACE(TRACE2_TRANSACTION, "Row: " << setfill(' ') << setw(4) << dec << redoLogRecord1->length <<
-                                        ":" << setfill(' ') << setw(4) << dec << redoLogRecord2->length <<
-                                    " fb: " << setfill('0') << setw(2) << hex << (uint64_t)redoLogRecord1->fb <<
-                                        ":" << setfill('0') << setw(2) << hex << (uint64_t)redoLogRecord2->fb << " " <<
-                                    " op: " << setfill('0') << setw(8) << hex << op <<
-                                    " scn: " << dec << redoLogRecord1->scn <<
-                                    " subScn: " << dec << redoLogRecord1->subScn <<
-                                    " scnRecord: " << dec << redoLogRecord1->scnRecord <<
-                                    " objn: " << dec << redoLogRecord1->objn <<
-                                    " objd: " << dec << redoLogRecord1->objd <<
-                                    " flg1: 0x" << setfill('0') << setw(4) << hex << redoLogRecord1->flg <<
-                                    " flg2: 0x" << setfill('0') << setw(4) << hex << redoLogRecord2->flg <<
-                                    " uba1: " << PRINTUBA(redoLogRecord1->uba) <<
-                                    " uba2: " << PRINTUBA(redoLogRecord2->uba) <<
-                                    " bdba1: 0x" << setfill('0') << setw(8) << hex << redoLogRecord1->bdba << "." << hex << (uint64_t)redoLogRecord1->slot <<
-                                    " nrid1: 0x" << setfill('0') << setw(8) << hex << redoLogRecord1->nridBdba << "." << hex << redoLogRecord1->nridSlot <<
-                                    " bdba2: 0x" << setfill('0') << setw(8) << hex << redoLogRecord2->bdba << "." << hex << (uint64_t)redoLogRecord2->slot <<
-                                    " nrid2: 0x" << setfill('0') << setw(8) << hex << redoLogRecord2->nridBdba << "." << hex << redoLogRecord2->nridSlot <<
-                                    " supp: (0x" << setfill('0') << setw(2) << hex << (uint64_t)redoLogRecord1->suppLogFb <<
-                                        ", " << setfill(' ') << setw(3) << dec << (uint64_t)redoLogRecord1->suppLogType <<
-                                        ", " << setfill(' ') << setw(3) << dec << redoLogRecord1->suppLogCC <<
-                                        ", " << setfill(' ') << setw(3) << dec << redoLogRecord1->suppLogBefore <<
-                                        ", " << setfill(' ') << setw(3) << dec << redoLogRecord1->suppLogAfter <<
-                                        ", 0x" << setfill('0') << setw(8) << hex << redoLogRecord1->suppLogBdba << "." << hex << redoLogRecord1->suppLogSlot << ")");
-
-                    //undo split
-                    if ((redoLogRecord1->flg & FLG_MULTIBLOCKUNDOTAIL) != 0) {
-                        if (last501 != nullptr || op != 0x05010000) {
-                            RUNTIME_FAIL("split undo TAIL error");
-                        }
-                        last501 = redoLogRecord1;
-                        continue;
-                    } else
+                //undo split
+                if ((redoLogRecord1->flg & FLG_MULTIBLOCKUNDOTAIL) != 0) {
+                    if (last501 != nullptr || op != 0x05010000) {
+                        RUNTIME_FAIL("split undo TAIL error");
+                    }
+                    last501 = redoLogRecord1;
+                    continue;
+                } else
 
-                    if ((redoLogRecord1->flg & FLG_MULTIBLOCKUNDOMID) != 0) {
-                        if (last501 == nullptr || op != 0x05010000) {
-                            RUNTIME_FAIL("split undo MID error");
-                        }
+                if ((redoLogRecord1->flg & FLG_MULTIBLOCKUNDOMID) != 0) {
+                    if (last501 == nullptr || op != 0x05010000) {
+                        RUNTIME_FAIL("split undo MID error");
+                    }
 
-                        uint64_t size = last501->length + redoLogRecord1->length;
-                        uint8_t *merge = new uint8_t[size];
-                        if (merge == nullptr) {
-                            RUNTIME_FAIL("couldn't allocate " << dec << size << " bytes memory (for: merge split undo #1)");
-                        }
-                        merges.push_back(merge);
-                        mergeBlocks(merge, redoLogRecord1, last501);
-                        last501 = redoLogRecord1;
-                        continue;
-                    } else
+                    uint64_t size = last501->length + redoLogRecord1->length;
+                    uint8_t *merge = new uint8_t[size];
+                    if (merge == nullptr) {
+                        RUNTIME_FAIL("couldn't allocate " << dec << size << " bytes memory (for: merge split undo #1)");
+                    }
+                    merges.push_back(merge);
+                    mergeBlocks(merge, redoLogRecord1, last501);
+                    last501 = redoLogRecord1;
+                    continue;
+                } else
+
+                if ((redoLogRecord1->flg & FLG_MULTIBLOCKUNDOHEAD) != 0) {
+                    if (last501 == nullptr || op == 0x05010000) {
+                        RUNTIME_FAIL("split undo HEAD error");
+                    }
 
-                    if ((redoLogRecord1->flg & FLG_MULTIBLOCKUNDOHEAD) != 0) {
-                        if (last501 == nullptr || op == 0x05010000) {
-                            RUNTIME_FAIL("split undo HEAD error");
-                        }
+                    uint64_t size = last501->length + redoLogRecord1->length;
+                    uint8_t *merge = new uint8_t[size];
+                    if (merge == nullptr) {
+                        RUNTIME_FAIL("couldn't allocate " << dec << size << " bytes memory (for: merge split undo #1)");
+                    }
+                    merges.push_back(merge);
+                    mergeBlocks(merge, redoLogRecord1, last501);
 
-                        uint64_t size = last501->length + redoLogRecord1->length;
-                        uint8_t *merge = new uint8_t[size];
-                        if (merge == nullptr) {
-                            RUNTIME_FAIL("couldn't allocate " << dec << size << " bytes memory (for: merge split undo #1)");
-                        }
-                        merges.push_back(merge);
-                        mergeBlocks(merge, redoLogRecord1, last501);
+                    uint16_t fieldPos = redoLogRecord1->fieldPos;
+                    uint16_t fieldLength = oracleAnalyzer->read16(redoLogRecord1->data + redoLogRecord1->fieldLengthsDelta + 1 * 2);
+                    fieldPos += (fieldLength + 3) & 0xFFFC;
 
-                        uint16_t fieldPos = redoLogRecord1->fieldPos;
-                        uint16_t fieldLength = oracleAnalyzer->read16(redoLogRecord1->data + redoLogRecord1->fieldLengthsDelta + 1 * 2);
-                        fieldPos += (fieldLength + 3) & 0xFFFC;
+                    uint16_t flg = oracleAnalyzer->read16(redoLogRecord1->data + fieldPos + 20);
+                    flg &= ~(FLG_MULTIBLOCKUNDOHEAD | FLG_MULTIBLOCKUNDOMID | FLG_MULTIBLOCKUNDOTAIL | FLG_LASTBUFFERSPLIT);
+                    oracleAnalyzer->write16(redoLogRecord1->data + fieldPos + 20, flg);
 
-                        uint16_t flg = oracleAnalyzer->read16(redoLogRecord1->data + fieldPos + 20);
-                        flg &= ~(FLG_MULTIBLOCKUNDOHEAD | FLG_MULTIBLOCKUNDOMID | FLG_MULTIBLOCKUNDOTAIL | FLG_LASTBUFFERSPLIT);
-                        oracleAnalyzer->write16(redoLogRecord1->data + fieldPos + 20, flg);
+                    OpCode0501 *opCode0501 = new OpCode0501(oracleAnalyzer, redoLogRecord1);
+                    if (opCode0501 == nullptr) {
+                        RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0501) << " bytes memory (for: merge split blocks #3)");
+                    }
 
-                        OpCode0501 *opCode0501 = new OpCode0501(oracleAnalyzer, redoLogRecord1);
-                        if (opCode0501 == nullptr) {
-                            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(OpCode0501) << " bytes memory (for: merge split blocks #3)");
-                        }
+                    opCode0501->process();
+                    delete opCode0501;
+                    opCode0501 = nullptr;
+                    last501 = nullptr;
+                } else if (last501 != nullptr) {
+                    RUNTIME_FAIL("split undo is broken");
+                }
 
-                        opCode0501->process();
-                        delete opCode0501;
-                        opCode0501 = nullptr;
-                        last501 = nullptr;
-                    } else if (last501 != nullptr) {
-                        RUNTIME_FAIL("split undo is broken");
+                opFlush = false;
+                switch (op) {
+                //insert row piece
+                case 0x05010B02:
+                //delete row piece
+                case 0x05010B03:
+                //update row piece
+                case 0x05010B05:
+                //overwrite row piece
+                case 0x05010B06:
+                //change row forwarding address
+                case 0x05010B08:
+                //supp log for update
+                case 0x05010B10:
+
+                    redoLogRecord2->suppLogAfter = redoLogRecord1->suppLogAfter;
+
+                    if (type == 0) {
+                        if (op == 0x05010B02)
+                            type = TRANSACTION_INSERT;
+                        else if (op == 0x05010B03)
+                            type = TRANSACTION_DELETE;
+                        else
+                            type = TRANSACTION_UPDATE;
+                    } else
+                    if (type == TRANSACTION_INSERT) {
+                        if (op == 0x05010B03 || op == 0x05010B05 || op == 0x05010B06 || op == 0x05010B08)
+                            type = TRANSACTION_UPDATE;
+                    } else
+                    if (type == TRANSACTION_DELETE) {
+                        if (op == 0x05010B02 || op == 0x05010B05 || op == 0x05010B06 || op == 0x05010B08)
+                            type = TRANSACTION_UPDATE;
                     }
 
-                    opFlush = false;
-                    switch (op) {
-                    //insert row piece
-                    case 0x05010B02:
-                    //delete row piece
-                    case 0x05010B03:
-                    //update row piece
-                    case 0x05010B05:
-                    //overwrite row piece
-                    case 0x05010B06:
-                    //change row forwarding address
-                    case 0x05010B08:
-                    //supp log for update
-                    case 0x05010B10:
-
-                        redoLogRecord2->suppLogAfter = redoLogRecord1->suppLogAfter;
-
-                        if (type == 0) {
-                            if (op == 0x05010B02)
-                                type = TRANSACTION_INSERT;
-                            else if (op == 0x05010B03)
-                                type = TRANSACTION_DELETE;
-                            else
-                                type = TRANSACTION_UPDATE;
-                        } else
-                        if (type == TRANSACTION_INSERT) {
-                            if (op == 0x05010B03 || op == 0x05010B05 || op == 0x05010B06 || op == 0x05010B08)
-                                type = TRANSACTION_UPDATE;
-                        } else
-                        if (type == TRANSACTION_DELETE) {
-                            if (op == 0x05010B02 || op == 0x05010B05 || op == 0x05010B06 || op == 0x05010B08)
-                                type = TRANSACTION_UPDATE;
-                        }
-
-                        if (redoLogRecord1->suppLogType == 0) {
-                            RUNTIME_FAIL("SUPPLEMENTAL_LOG_DATA_MIN missing" << endl <<
-                                    "HINT run: ALTER DATABASE ADD SUPPLEMENTAL LOG DATA;" << endl <<
-                                    "HINT run: ALTER SYSTEM ARCHIVE LOG CURRENT;");
-                        }
+                    if (redoLogRecord1->suppLogType == 0) {
+                        RUNTIME_FAIL("SUPPLEMENTAL_LOG_DATA_MIN missing" << endl <<
+                                "HINT run: ALTER DATABASE ADD SUPPLEMENTAL LOG DATA;" << endl <<
+                                "HINT run: ALTER SYSTEM ARCHIVE LOG CURRENT;");
+                    }
 
-                        if (first1 == nullptr) {
-                            first1 = redoLogRecord1;
-                            first2 = redoLogRecord2;
-                            last1 = redoLogRecord1;
-                            last2 = redoLogRecord2;
-                        } else {
-                            if (last1->suppLogBdba == redoLogRecord1->suppLogBdba && last1->suppLogSlot == redoLogRecord1->suppLogSlot &&
-                                    first1->object == redoLogRecord1->object && first2->object == redoLogRecord2->object) {
-                                if (type == TRANSACTION_INSERT) {
-                                    redoLogRecord1->next = first1;
-                                    redoLogRecord2->next = first2;
-                                    first1->prev = redoLogRecord1;
-                                    first2->prev = redoLogRecord2;
-                                    first1 = redoLogRecord1;
-                                    first2 = redoLogRecord2;
-                                } else {
-                                    if (op == 0x05010B06 && last2->opCode == 0x0B02) {
-                                        if (last1->prev == nullptr) {
-                                            first1 = redoLogRecord1;
-                                            first2 = redoLogRecord2;
-                                            first1->next = last1;
-                                            first2->next = last2;
-                                            last1->prev = first1;
-                                            last2->prev = first2;
-                                        } else {
-                                            redoLogRecord1->prev = last1->prev;
-                                            redoLogRecord2->prev = last2->prev;
-                                            redoLogRecord1->next = last1;
-                                            redoLogRecord2->next = last2;
-                                            last1->prev->next = redoLogRecord1;
-                                            last2->prev->next = redoLogRecord2;
-                                            last1->prev = redoLogRecord1;
-                                            last2->prev = redoLogRecord2;
-                                        }
+                    if (first1 == nullptr) {
+                        first1 = redoLogRecord1;
+                        first2 = redoLogRecord2;
+                        last1 = redoLogRecord1;
+                        last2 = redoLogRecord2;
+                    } else {
+                        if (last1->suppLogBdba == redoLogRecord1->suppLogBdba && last1->suppLogSlot == redoLogRecord1->suppLogSlot &&
+                                first1->object == redoLogRecord1->object && first2->object == redoLogRecord2->object) {
+                            if (type == TRANSACTION_INSERT) {
+                                redoLogRecord1->next = first1;
+                                redoLogRecord2->next = first2;
+                                first1->prev = redoLogRecord1;
+                                first2->prev = redoLogRecord2;
+                                first1 = redoLogRecord1;
+                                first2 = redoLogRecord2;
+                            } else {
+                                if (op == 0x05010B06 && last2->opCode == 0x0B02) {
+                                    if (last1->prev == nullptr) {
+                                        first1 = redoLogRecord1;
+                                        first2 = redoLogRecord2;
+                                        first1->next = last1;
+                                        first2->next = last2;
+                                        last1->prev = first1;
+                                        last2->prev = first2;
                                     } else {
-                                        last1->next = redoLogRecord1;
-                                        last2->next = redoLogRecord2;
-                                        redoLogRecord1->prev = last1;
-                                        redoLogRecord2->prev = last2;
-                                        last1 = redoLogRecord1;
-                                        last2 = redoLogRecord2;
+                                        redoLogRecord1->prev = last1->prev;
+                                        redoLogRecord2->prev = last2->prev;
+                                        redoLogRecord1->next = last1;
+                                        redoLogRecord2->next = last2;
+                                        last1->prev->next = redoLogRecord1;
+                                        last2->prev->next = redoLogRecord2;
+                                        last1->prev = redoLogRecord1;
+                                        last2->prev = redoLogRecord2;
                                     }
+                                } else {
+                                    last1->next = redoLogRecord1;
+                                    last2->next = redoLogRecord2;
+                                    redoLogRecord1->prev = last1;
+                                    redoLogRecord2->prev = last2;
+                                    last1 = redoLogRecord1;
+                                    last2 = redoLogRecord2;
                                 }
-                            } else {
-                                RUNTIME_FAIL("next BDBA/SLOT does not match");
                             }
+                        } else {
+                            RUNTIME_FAIL("next BDBA/SLOT does not match");
                         }
-
-                        if ((redoLogRecord1->suppLogFb & FB_L) != 0) {
-                            oracleAnalyzer->outputBuffer->processDML(first1, first2, type);
-                            opFlush = true;
-                        }
-                        break;
-
-                    //insert multiple rows
-                    case 0x05010B0B:
-                        oracleAnalyzer->outputBuffer->processInsertMultiple(redoLogRecord1, redoLogRecord2);
-                        opFlush = true;
-                        break;
-
-                    //delete multiple rows
-                    case 0x05010B0C:
-                        oracleAnalyzer->outputBuffer->processDeleteMultiple(redoLogRecord1, redoLogRecord2);
-                        opFlush = true;
-                        break;
-
-                    //truncate table
-                    case 0x18010000:
-                        oracleAnalyzer->outputBuffer->processDDLheader(redoLogRecord1);
-                        opFlush = true;
-                        break;
-
-                    //should not happen
-                    default:
-                        RUNTIME_FAIL("Unknown OpCode " << hex << op);
                     }
 
-                    //split very big transactions
-                    if (oracleAnalyzer->outputBuffer->writer->maxMessageMb > 0 &&
-                            oracleAnalyzer->outputBuffer->outputBufferSize() + DATA_BUFFER_SIZE > oracleAnalyzer->outputBuffer->writer->maxMessageMb * 1024 * 1024) {
-                        WARNING("big transaction divided (forced commit after " << oracleAnalyzer->outputBuffer->outputBufferSize() << " bytes)");
-                        oracleAnalyzer->outputBuffer->processCommit();
-                        oracleAnalyzer->outputBuffer->processBegin(commitScn, commitTimestamp, xid);
+                    if ((redoLogRecord1->suppLogFb & FB_L) != 0) {
+                        outputBuffer->processDML(first1, first2, type);
+                        opFlush = true;
                     }
+                    break;
+
+                //insert multiple rows
+                case 0x05010B0B:
+                    outputBuffer->processInsertMultiple(redoLogRecord1, redoLogRecord2);
+                    opFlush = true;
+                    break;
+
+                //delete multiple rows
+                case 0x05010B0C:
+                    outputBuffer->processDeleteMultiple(redoLogRecord1, redoLogRecord2);
+                    opFlush = true;
+                    break;
+
+                //truncate table
+                case 0x18010000:
+                    //DDL is not reverted
+                    if (!outputBuffer->compensate)
+                        outputBuffer->processDDLheader(redoLogRecord1);
+                    opFlush = true;
+                    break;
+
+                //should not happen
+                default:
+                    RUNTIME_FAIL("Unknown OpCode " << hex << op);
+                }
 
-                    if (opFlush) {
-                        first1 = nullptr;
-                        last1 = nullptr;
-                        first2 = nullptr;
-                        last2 = nullptr;
-                        type = 0;
-
-                        while (deallocTc != nullptr) {
-                            TransactionChunk *nextTc = deallocTc->next;
-                            oracleAnalyzer->transactionBuffer->deleteTransactionChunk(deallocTc);
-                            deallocTc = nextTc;
-                        }
+                //split very big transactions
+                if (oracleAnalyzer->outputBuffer->writer->maxMessageMb > 0 &&
+                        outputBuffer->outputBufferSize() + DATA_BUFFER_SIZE > oracleAnalyzer->outputBuffer->writer->maxMessageMb * 1024 * 1024) {
+                    WARNING("big transaction divided (forced commit after " << outputBuffer->outputBufferSize() << " bytes)");
+                    outputBuffer->processCommit();
+                    outputBuffer->processBegin(scn, time, xid);
+                }
 
-                        for (uint8_t* buf : merges)
-                            delete[] buf;
-                        merges.clear();
+                if (opFlush) {
+                    first1 = nullptr;
+                    last1 = nullptr;
+                    first2 = nullptr;
+                    last2 = nullptr;
+                    type = 0;
+
+                    while (deallocTc != nullptr) {
+                        TransactionChunk *nextTc = deallocTc->next;
+                        oracleAnalyzer->transactionBuffer->deleteTransactionChunk(deallocTc);
+                        deallocTc = nextTc;
                     }
+
+                    for (uint8_t* buf : merges)
+                        delete[] buf;
+                    merges.clear();
                 }
+            }
 
-                TransactionChunk *nextTc = tc->next;
+            //formatter thread leaves chunks to be released by the analyzer thread
+            TransactionChunk *nextTc = tc->next;
+            if (release) {
                 tc->next = deallocTc;
                 deallocTc = tc;
-                tc = nextTc;
-                firstTc = tc;
+                firstTc = nextTc;
             }
+            tc = nextTc;
+            index = 0;
+        }
 
+        if (release) {
             while (deallocTc != nullptr) {
                 TransactionChunk *nextTc = deallocTc->next;
                 oracleAnalyzer->transactionBuffer->deleteTransactionChunk(deallocTc);
                 deallocTc = nextTc;
             }
 
-            firstTc = nullptr;
-            lastTc = nullptr;
-            opCodes = 0;
+            firstTc = tc;
+            if (tc != nullptr)
+                tc->prev = nullptr;
+        }
+    }
 
-            oracleAnalyzer->outputBuffer->processCommit();
+    void Transaction::writeRecord(ostream &os, RedoLogRecord *redoLogRecord) {
+        SNAPSHOT_RECORD_FIELDS(SNAPSHOT_WRITE_FIELD)
+    }
+
+    void Transaction::readRecord(istream &is, RedoLogRecord *redoLogRecord) {
+        SNAPSHOT_RECORD_FIELDS(SNAPSHOT_READ_FIELD)
+    }
+
+    void Transaction::writeSnapshot(ostream &os) {
+        applyRollback();
+
+        uint64_t header[8];
+        header[0] = xid;
+        header[1] = firstSequence;
+        header[2] = firstPos;
+        header[3] = opCodes;
+        header[4] = streamedOps;
+        header[5] = (isBegin ? 1 : 0) | (shutdown ? 2 : 0) | (skip ? 8 : 0) | ((uint64_t)firstTime.getVal() << 32);
+        header[6] = 0;
+        for (TransactionChunk *tc = firstTc; tc != nullptr; tc = tc->next)
+            header[6] += tc->elements;
+        header[7] = firstScn;
+        os.write((const char*)header, sizeof(header));
+
+        for (TransactionChunk *tc = firstTc; tc != nullptr; tc = tc->next) {
+            uint64_t pos = 0;
+            for (uint64_t i = 0; i < tc->elements; ++i) {
+                RedoLogRecord *redoLogRecord1 = ((RedoLogRecord *)(tc->buffer + pos + ROW_HEADER_REDO1)),
+                              *redoLogRecord2 = ((RedoLogRecord *)(tc->buffer + pos + ROW_HEADER_REDO2));
+                writeRecord(os, redoLogRecord1);
+                writeRecord(os, redoLogRecord2);
+
+                if (redoLogRecord1->lwnChunk == nullptr) {
+                    os.write((const char*)(tc->buffer + pos + ROW_HEADER_DATA), redoLogRecord1->length + redoLogRecord2->length);
+                    pos += redoLogRecord1->length + redoLogRecord2->length + ROW_HEADER_TOTAL;
+                } else {
+                    os.write((const char*)redoLogRecord1->data, redoLogRecord1->length);
+                    os.write((const char*)redoLogRecord2->data, redoLogRecord2->length);
+                    pos += ROW_HEADER_TOTAL;
+                }
+            }
+        }
+    }
+
+    Transaction *Transaction::readSnapshot(OracleAnalyzer *oracleAnalyzer, istream &is) {
+        uint64_t header[8];
+        is.read((char*)header, sizeof(header));
+        if (is.fail())
+            return nullptr;
+
+        Transaction *transaction = oracleAnalyzer->transactionBuffer->newTransaction(header[0]);
+        RedoLogRecord redoLogRecord1, redoLogRecord2;
+        vector<uint8_t> data;
+        uint64_t dropped = 0, droppedStreamed = 0;
+
+        for (uint64_t i = 0; i < header[6]; ++i) {
+            memset((void*)&redoLogRecord1, 0, sizeof(struct RedoLogRecord));
+            memset((void*)&redoLogRecord2, 0, sizeof(struct RedoLogRecord));
+            readRecord(is, &redoLogRecord1);
+            readRecord(is, &redoLogRecord2);
+            if (is.fail()) {
+                oracleAnalyzer->transactionBuffer->deleteTransaction(transaction);
+                return nullptr;
+            }
+
+            data.resize(redoLogRecord1.length + redoLogRecord2.length);
+            is.read((char*)data.data(), data.size());
+            if (is.fail()) {
+                oracleAnalyzer->transactionBuffer->deleteTransaction(transaction);
+                return nullptr;
+            }
+
+            redoLogRecord1.next = nullptr;
+            redoLogRecord1.prev = nullptr;
+            redoLogRecord1.lwnChunk = nullptr;
+            redoLogRecord1.data = data.data();
+            redoLogRecord2.next = nullptr;
+            redoLogRecord2.prev = nullptr;
+            redoLogRecord2.lwnChunk = nullptr;
+            redoLogRecord2.data = data.data() + redoLogRecord1.length;
+
+            //table removed from configuration since snapshot was written
+            redoLogRecord1.object = oracleAnalyzer->schema->checkDict(redoLogRecord1.objn, redoLogRecord1.objd);
+            if (redoLogRecord1.object == nullptr) {
+                if (dropped + droppedStreamed == 0) {
+                    WARNING("snapshot of transaction " << PRINTXID(header[0]) << " references object not present in schema (objn: " <<
+                            dec << redoLogRecord1.objn << ", objd: " << redoLogRecord1.objd << "), dropping its rows");
+                }
+                //streamed rows come first
+                if (i < header[4])
+                    ++droppedStreamed;
+                else
+                    ++dropped;
+                continue;
+            }
+            redoLogRecord2.object = (redoLogRecord2.opCode != 0) ? redoLogRecord1.object : nullptr;
+
+            transaction->add(&redoLogRecord1, &redoLogRecord2);
         }
+
+        transaction->firstSequence = header[1];
+        transaction->firstPos = header[2];
+        transaction->opCodes = (header[3] > dropped) ? header[3] - dropped : 0;
+        transaction->streamedOps = header[4] - droppedStreamed;
+        transaction->isBegin = (header[5] & 1) != 0;
+        transaction->shutdown = (header[5] & 2) != 0;
+        transaction->skip = (header[5] & 8) != 0;
+        transaction->firstTime = (uint32_t)(header[5] >> 32);
+        transaction->firstScn = header[7];
+        return transaction;
     }
 
     ostream& operator<<(ostream& os, const Transaction& tran) {
@@ -395,8 +808,9 @@ namespace OpenLogReplicator {
                 " seq: " << dec << tran.firstSequence <<
                 " pos: " << dec << tran.firstPos <<
                 " xid: " << PRINTXID(tran.xid) <<
-                " flags: " << dec << tran.isBegin << "/" << tran.isRollback <<
+                " flags: " << dec << tran.isBegin << "/" << tran.isRollback << "/" << tran.skip <<
                 " op: " << dec << tran.opCodes <<
+                " streamed: " << dec << tran.streamedOps <<
                 " chunks: " << dec << tcCount <<
                 " sz: " << tcSumSize;
         return os;
@@ -17,6 +17,8 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <istream>
+#include <ostream>
 #include <vector>
 
 #include "types.h"
@@ -32,34 +34,59 @@ namespace OpenLogReplicator {
     class OpCode0504;
     class RedoLogRecord;
     class OracleAnalyzer;
+    class OutputBuffer;
 
     class Transaction {
     protected:
         OracleAnalyzer *oracleAnalyzer;
         vector<uint8_t*> merges;
         void mergeBlocks(uint8_t *buffer, RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2);
+        static void writeRecord(ostream &os, RedoLogRecord *redoLogRecord);
+        static void readRecord(istream &is, RedoLogRecord *redoLogRecord);
+        void flushChunks(OutputBuffer *outputBuffer, TransactionChunk *tc, uint64_t index, uint64_t ops, typescn scn, typetime time, bool release);
+        void flushRevert(OutputBuffer *outputBuffer, uint64_t ops, typescn scn, typetime time);
+        void revertStreamed(bool force);
+        bool opStart(TransactionChunk *tc, uint64_t index, uint64_t pos) const;
 
     public:
+        //fields used for every appended vector first
         typexid xid;
-        typeseq firstSequence;
-        uint64_t firstPos;
-        typescn commitScn;
         TransactionChunk *firstTc;
         TransactionChunk *lastTc;
         uint64_t opCodes;
+        uint64_t streamedOps;
+        uint64_t rollbackOps;
+        uint64_t revertOps;
+        typescn revertScn;
+        typetime revertTime;
+        typeseq firstSequence;
+        uint64_t firstPos;
+        typescn commitScn;
+        typescn firstScn;
+        typetime firstTime;
+        vector<uint8_t*> lwnChunks;
         uint64_t pos;
         typetime commitTimestamp;
         bool isBegin;
         bool isRollback;
         bool shutdown;
+        bool skip;
+        bool lwnCopy;
 
         Transaction(OracleAnalyzer *oracleAnalyzer, typexid xid);
         virtual ~Transaction();
 
         void add(RedoLogRecord *redoLogRecord);
         void add(RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2);
-        void rollbackLastOp(typescn scn);
+        void rollbackLastOp(typescn scn, typetime time);
+        void applyRollback(void);
+        void skipSession(void);
+        void getSize(uint64_t &chunks, uint64_t &bytes, uint64_t &lwnBytes) const;
         void flush(void);
+        void format(OutputBuffer *outputBuffer);
+        void flushStream(typescn scn, typetime time);
+        void writeSnapshot(ostream &os);
+        static Transaction *readSnapshot(OracleAnalyzer *oracleAnalyzer, istream &is);
         friend ostream& operator<<(ostream& os, const Transaction& tran);
     };
 }
@@ -18,6 +18,7 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
 #include "OracleAnalyzer.h"
+#include "RedoLog.h"
 #include "RedoLogRecord.h"
 #include "RuntimeException.h"
 #include "Transaction.h"
@@ -28,19 +29,57 @@ using namespace std;
 namespace OpenLogReplicator {
 
     TransactionBuffer::TransactionBuffer(OracleAnalyzer *oracleAnalyzer) :
-        oracleAnalyzer(oracleAnalyzer) {
+        oracleAnalyzer(oracleAnalyzer),
+        freeTc(nullptr),
+        freeTcCount(0),
+        lwnChunksRetained(0),
+        lwnChunksPinned(0),
+        lwnChunksPinnedHWM(0) {
     }
 
     TransactionBuffer::~TransactionBuffer() {
+        while (freeTc != nullptr) {
+            TransactionChunk *tc = freeTc;
+            freeTc = tc->next;
+            releaseTransactionChunk(tc);
+        }
+        freeTcCount = 0;
+
         if (partiallyFullChunks.size() > 0) {
             RUNTIME_FAIL("non free blocks in transaction buffer: " << dec << partiallyFullChunks.size());
         }
     }
 
+    Transaction *TransactionBuffer::newTransaction(typexid xid) {
+        Transaction *transaction = new Transaction(oracleAnalyzer, xid);
+        if (transaction == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(Transaction) << " bytes memory (for: transaction)");
+        }
+        return transaction;
+    }
+
+    void TransactionBuffer::deleteTransaction(Transaction *transaction) {
+        delete transaction;
+    }
+
     TransactionChunk *TransactionBuffer::newTransactionChunk(void) {
         uint8_t *chunk;
         TransactionChunk *tc;
         uint64_t pos, freeMap;
+
+        //recently freed chunk, a new transaction mostly gets its first chunk from here without searching partially full chunks
+        if (freeTc != nullptr) {
+            tc = freeTc;
+            freeTc = tc->next;
+            --freeTcCount;
+            chunk = tc->header;
+            pos = tc->pos;
+            memset(tc, 0, HEADER_BUFFER_SIZE);
+            tc->header = chunk;
+            tc->pos = pos;
+            return tc;
+        }
+
         if (partiallyFullChunks.size() > 0) {
             chunk = partiallyFullChunks.begin()->first;
             freeMap = partiallyFullChunks.begin()->second;
@@ -65,6 +104,17 @@ namespace OpenLogReplicator {
     }
 
     void TransactionBuffer::deleteTransactionChunk(TransactionChunk* tc) {
+        if (freeTcCount < TRANSACTION_CHUNK_CACHE_MAX) {
+            tc->next = freeTc;
+            freeTc = tc;
+            ++freeTcCount;
+            return;
+        }
+
+        releaseTransactionChunk(tc);
+    }
+
+    void TransactionBuffer::releaseTransactionChunk(TransactionChunk* tc) {
         uint8_t *chunk = tc->header;
         uint64_t pos = tc->pos;
         uint64_t freeMap = partiallyFullChunks[chunk];
@@ -88,9 +138,12 @@ namespace OpenLogReplicator {
     }
 
     void TransactionBuffer::addTransactionChunk(Transaction *transaction, RedoLogRecord *redoLogRecord) {
+        //vector data in LWN chunk is not copied, the chunk is retained by the transaction
+        bool retained = (redoLogRecord->lwnChunk != nullptr && !transaction->lwnCopy);
+        uint64_t dataLength = retained ? 0 : redoLogRecord->length;
 
-        if (redoLogRecord->length + ROW_HEADER_TOTAL > DATA_BUFFER_SIZE) {
-            RUNTIME_FAIL(*oracleAnalyzer <<  "block size (" << dec << (redoLogRecord->length + ROW_HEADER_TOTAL)
+        if (dataLength + ROW_HEADER_TOTAL > DATA_BUFFER_SIZE) {
+            RUNTIME_FAIL(*oracleAnalyzer <<  "block size (" << dec << (dataLength + ROW_HEADER_TOTAL)
                     << ") exceeding max block size (" << FULL_BUFFER_SIZE << "), try increasing the FULL_BUFFER_SIZE parameter");
         }
 
@@ -101,7 +154,7 @@ namespace OpenLogReplicator {
         }
 
         //new block needed
-        if (transaction->lastTc->size + redoLogRecord->length + ROW_HEADER_TOTAL > DATA_BUFFER_SIZE) {
+        if (transaction->lastTc->size + dataLength + ROW_HEADER_TOTAL > DATA_BUFFER_SIZE) {
             TransactionChunk *tcNew = newTransactionChunk();
             tcNew->prev = transaction->lastTc;
             transaction->lastTc->next = tcNew;
@@ -113,18 +166,30 @@ namespace OpenLogReplicator {
         *((typeop2 *)(tc->buffer + tc->size + ROW_HEADER_OP)) = (redoLogRecord->opCode << 16);
         memcpy(tc->buffer + tc->size + ROW_HEADER_REDO1, redoLogRecord, sizeof(struct RedoLogRecord));
         memset(tc->buffer + tc->size + ROW_HEADER_REDO2, 0, sizeof(struct RedoLogRecord));
-        memcpy(tc->buffer + tc->size + ROW_HEADER_DATA, redoLogRecord->data, redoLogRecord->length);
+        if (retained)
+            retainLwnChunk(transaction, redoLogRecord->lwnChunk);
+        else {
+            ((RedoLogRecord *)(tc->buffer + tc->size + ROW_HEADER_REDO1))->lwnChunk = nullptr;
+            memcpy(tc->buffer + tc->size + ROW_HEADER_DATA, redoLogRecord->data, redoLogRecord->length);
+        }
 
-        *((uint64_t *)(tc->buffer + tc->size + ROW_HEADER_SIZE + redoLogRecord->length)) = redoLogRecord->length + ROW_HEADER_TOTAL;
+        *((uint64_t *)(tc->buffer + tc->size + ROW_HEADER_SIZE + dataLength)) = dataLength + ROW_HEADER_TOTAL;
 
-        tc->size += redoLogRecord->length + ROW_HEADER_TOTAL;
+        tc->size += dataLength + ROW_HEADER_TOTAL;
         ++tc->elements;
+
+        if (!transaction->lwnCopy && transaction->lwnChunks.size() > TRANSACTION_LWN_CHUNKS_MAX)
+            copyLwnChunks(transaction);
     }
 
     void TransactionBuffer::addTransactionChunk(Transaction *transaction, RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2) {
+        //vector data in LWN chunk is not copied, the chunk is retained by the transaction
+        bool retained = (redoLogRecord1->lwnChunk != nullptr && (redoLogRecord2->length == 0 || redoLogRecord2->lwnChunk != nullptr) &&
+                !transaction->lwnCopy);
+        uint64_t dataLength = retained ? 0 : redoLogRecord1->length + redoLogRecord2->length;
 
-        if (redoLogRecord1->length + redoLogRecord2->length + ROW_HEADER_TOTAL > DATA_BUFFER_SIZE) {
-            RUNTIME_FAIL(*oracleAnalyzer <<  "block size (" << dec << (redoLogRecord1->length + redoLogRecord2->length + ROW_HEADER_TOTAL)
+        if (dataLength + ROW_HEADER_TOTAL > DATA_BUFFER_SIZE) {
+            RUNTIME_FAIL(*oracleAnalyzer <<  "block size (" << dec << (dataLength + ROW_HEADER_TOTAL)
                     << ") exceeding max block size (" << FULL_BUFFER_SIZE << "), try increasing the FULL_BUFFER_SIZE parameter");
         }
 
@@ -135,7 +200,7 @@ namespace OpenLogReplicator {
         }
 
         //new block needed
-        if (transaction->lastTc->size + redoLogRecord1->length + redoLogRecord2->length + ROW_HEADER_TOTAL > DATA_BUFFER_SIZE) {
+        if (transaction->lastTc->size + dataLength + ROW_HEADER_TOTAL > DATA_BUFFER_SIZE) {
             TransactionChunk *tcNew = newTransactionChunk();
             tcNew->prev = transaction->lastTc;
             transaction->lastTc->next = tcNew;
@@ -147,32 +212,50 @@ namespace OpenLogReplicator {
         *((typeop2 *)(tc->buffer + tc->size + ROW_HEADER_OP)) = (redoLogRecord1->opCode << 16) | redoLogRecord2->opCode;
         memcpy(tc->buffer + tc->size + ROW_HEADER_REDO1, redoLogRecord1, sizeof(struct RedoLogRecord));
         memcpy(tc->buffer + tc->size + ROW_HEADER_REDO2, redoLogRecord2, sizeof(struct RedoLogRecord));
-        memcpy(tc->buffer + tc->size + ROW_HEADER_DATA, redoLogRecord1->data, redoLogRecord1->length);
-        memcpy(tc->buffer + tc->size + ROW_HEADER_DATA + redoLogRecord1->length, redoLogRecord2->data, redoLogRecord2->length);
+        if (retained) {
+            retainLwnChunk(transaction, redoLogRecord1->lwnChunk);
+            if (redoLogRecord2->lwnChunk != nullptr)
+                retainLwnChunk(transaction, redoLogRecord2->lwnChunk);
+        } else {
+            ((RedoLogRecord *)(tc->buffer + tc->size + ROW_HEADER_REDO1))->lwnChunk = nullptr;
+            ((RedoLogRecord *)(tc->buffer + tc->size + ROW_HEADER_REDO2))->lwnChunk = nullptr;
+            memcpy(tc->buffer + tc->size + ROW_HEADER_DATA, redoLogRecord1->data, redoLogRecord1->length);
+            memcpy(tc->buffer + tc->size + ROW_HEADER_DATA + redoLogRecord1->length, redoLogRecord2->data, redoLogRecord2->length);
+        }
 
-        *((uint64_t *)(tc->buffer + tc->size + ROW_HEADER_SIZE + redoLogRecord1->length + redoLogRecord2->length)) = redoLogRecord1->length + redoLogRecord2->length + ROW_HEADER_TOTAL;
+        *((uint64_t *)(tc->buffer + tc->size + ROW_HEADER_SIZE + dataLength)) = dataLength + ROW_HEADER_TOTAL;
 
-        tc->size += redoLogRecord1->length + redoLogRecord2->length + ROW_HEADER_TOTAL;
+        tc->size += dataLength + ROW_HEADER_TOTAL;
         ++tc->elements;
-    }
 
-    void TransactionBuffer::rollbackTransactionChunk(Transaction *transaction) {
-        if (transaction->lastTc == nullptr)
-            return;
+        if (!transaction->lwnCopy && transaction->lwnChunks.size() > TRANSACTION_LWN_CHUNKS_MAX)
+            copyLwnChunks(transaction);
+    }
 
-        if (transaction->lastTc->size < ROW_HEADER_TOTAL || transaction->lastTc->elements == 0) {
-            RUNTIME_FAIL(*oracleAnalyzer << "trying to remove from empty buffer size2: " << dec << transaction->lastTc->size << " elements: " <<
-                    dec << transaction->lastTc->elements);
-        }
+    void TransactionBuffer::rollbackTransactionChunks(Transaction *transaction, uint64_t count) {
+        while (count > 0) {
+            TransactionChunk *tc = transaction->lastTc;
+            if (tc == nullptr) {
+                RUNTIME_FAIL(*oracleAnalyzer << "trying to remove " << dec << count << " elements from empty buffer");
+            }
 
-        uint64_t lastSize = *((uint64_t *)(transaction->lastTc->buffer + transaction->lastTc->size - ROW_HEADER_TOTAL + ROW_HEADER_SIZE));
-        transaction->lastTc->size -= lastSize;
-        --transaction->lastTc->elements;
+            //whole chunk is released at once
+            if (count < tc->elements) {
+                for (; count > 0; --count) {
+                    if (tc->size < ROW_HEADER_TOTAL) {
+                        RUNTIME_FAIL(*oracleAnalyzer << "trying to remove from empty buffer size2: " << dec << tc->size << " elements: " <<
+                                dec << tc->elements);
+                    }
+
+                    uint64_t lastSize = *((uint64_t *)(tc->buffer + tc->size - ROW_HEADER_TOTAL + ROW_HEADER_SIZE));
+                    tc->size -= lastSize;
+                    --tc->elements;
+                }
+                break;
+            }
 
-        if (transaction->lastTc->elements == 0) {
-            TransactionChunk *tc = transaction->lastTc;
+            count -= tc->elements;
             transaction->lastTc = tc->prev;
-
             if (transaction->lastTc != nullptr) {
                 transaction->lastTc->next = nullptr;
             } else {
@@ -181,4 +264,88 @@ namespace OpenLogReplicator {
             deleteTransactionChunk(tc);
         }
     }
+
+    void TransactionBuffer::retainLwnChunk(Transaction *transaction, uint8_t *chunk) {
+        //at most TRANSACTION_LWN_CHUNKS_MAX entries, newest first as consecutive rows mostly share the same chunk
+        for (auto it = transaction->lwnChunks.rbegin(); it != transaction->lwnChunks.rend(); ++it) {
+            if (*it == chunk)
+                return;
+        }
+
+        uint64_t *length = (uint64_t *)chunk;
+        ++length[1];
+        transaction->lwnChunks.push_back(chunk);
+        ++lwnChunksRetained;
+    }
+
+    //reference of redo log, chunk still referenced by transactions stays pinned by them
+    void TransactionBuffer::releaseLwnChunk(uint8_t *chunk) {
+        uint64_t *length = (uint64_t *)chunk;
+        if (length[1] == 0) {
+            RUNTIME_FAIL("releasing LWN chunk which is not retained");
+        }
+
+        if (--length[1] == 0) {
+            oracleAnalyzer->freeMemoryChunk("LWN", chunk, false);
+            return;
+        }
+
+        ++lwnChunksPinned;
+        if (lwnChunksPinned > lwnChunksPinnedHWM)
+            lwnChunksPinnedHWM = lwnChunksPinned;
+    }
+
+    //references of transaction, last one frees a chunk already released by redo log
+    void TransactionBuffer::releaseLwnChunks(Transaction *transaction) {
+        for (uint8_t* chunk : transaction->lwnChunks) {
+            uint64_t *length = (uint64_t *)chunk;
+            if (length[1] == 0) {
+                RUNTIME_FAIL("releasing LWN chunk which is not retained");
+            }
+
+            --lwnChunksRetained;
+            if (--length[1] == 0) {
+                oracleAnalyzer->freeMemoryChunk("LWN", chunk, false);
+                --lwnChunksPinned;
+            }
+        }
+        transaction->lwnChunks.clear();
+    }
+
+    //long transaction with rows spread over many LWN chunks keeps them all alive, rows are copied to own chunks instead
+    void TransactionBuffer::copyLwnChunks(Transaction *transaction) {
+        TransactionChunk *tc = transaction->firstTc;
+        transaction->firstTc = nullptr;
+        transaction->lastTc = nullptr;
+        transaction->lwnCopy = true;
+
+        TRACE(TRACE2_TRANSACTION, "copying rows of transaction " << PRINTXID(transaction->xid) << " from " << dec <<
+                transaction->lwnChunks.size() << " LWN chunks");
+
+        while (tc != nullptr) {
+            uint64_t pos = 0;
+            for (uint64_t i = 0; i < tc->elements; ++i) {
+                RedoLogRecord redoLogRecord1, redoLogRecord2;
+                memcpy(&redoLogRecord1, tc->buffer + pos + ROW_HEADER_REDO1, sizeof(struct RedoLogRecord));
+                memcpy(&redoLogRecord2, tc->buffer + pos + ROW_HEADER_REDO2, sizeof(struct RedoLogRecord));
+
+                if (redoLogRecord1.lwnChunk == nullptr) {
+                    redoLogRecord1.data = tc->buffer + pos + ROW_HEADER_DATA;
+                    redoLogRecord2.data = tc->buffer + pos + ROW_HEADER_DATA + redoLogRecord1.length;
+                    pos += redoLogRecord1.length + redoLogRecord2.length + ROW_HEADER_TOTAL;
+                } else
+                    pos += ROW_HEADER_TOTAL;
+                redoLogRecord1.lwnChunk = nullptr;
+                redoLogRecord2.lwnChunk = nullptr;
+
+                addTransactionChunk(transaction, &redoLogRecord1, &redoLogRecord2);
+            }
+
+            TransactionChunk *nextTc = tc->next;
+            deleteTransactionChunk(tc);
+            tc = nextTc;
+        }
+
+        releaseLwnChunks(transaction);
+    }
 }
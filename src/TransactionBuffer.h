@@ -35,6 +35,10 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #define HEADER_BUFFER_SIZE  (sizeof(uint64_t)+sizeof(uint64_t)+sizeof(uint64_t)+sizeof(uint8_t*)+sizeof(TransactionChunk*)+sizeof(TransactionChunk*))
 #define DATA_BUFFER_SIZE    (FULL_BUFFER_SIZE-HEADER_BUFFER_SIZE)
 #define BUFFERS_FREE_MASK   0xFFFF
+#ifndef TRANSACTION_CHUNK_CACHE_MAX
+#define TRANSACTION_CHUNK_CACHE_MAX 64
+#endif
+#define TRANSACTION_LWN_CHUNKS_MAX 16
 
 namespace OpenLogReplicator {
 
@@ -57,18 +61,30 @@ namespace OpenLogReplicator {
     protected:
         OracleAnalyzer *oracleAnalyzer;
         uint8_t buffer[DATA_BUFFER_SIZE];
+        TransactionChunk *freeTc;
+        uint64_t freeTcCount;
 
     public:
         unordered_map<uint8_t*,uint64_t> partiallyFullChunks;
+        uint64_t lwnChunksRetained;         //references to LWN chunks held by transactions
+        uint64_t lwnChunksPinned;           //LWN chunks already released by redo log, held only by transactions
+        uint64_t lwnChunksPinnedHWM;
 
         TransactionBuffer(OracleAnalyzer *oracleAnalyzer);
         virtual ~TransactionBuffer();
 
+        Transaction* newTransaction(typexid xid);
+        void deleteTransaction(Transaction *transaction);
         TransactionChunk* newTransactionChunk(void);
         void addTransactionChunk(Transaction *transaction, RedoLogRecord *redoLogRecord1);
         void addTransactionChunk(Transaction *transaction, RedoLogRecord *redoLogRecord1, RedoLogRecord *redoLogRecord2);
-        void rollbackTransactionChunk(Transaction *transaction);
+        void rollbackTransactionChunks(Transaction *transaction, uint64_t count);
+        void retainLwnChunk(Transaction *transaction, uint8_t *chunk);
+        void releaseLwnChunk(uint8_t *chunk);
+        void releaseLwnChunks(Transaction *transaction);
+        void copyLwnChunks(Transaction *transaction);
         void deleteTransactionChunk(TransactionChunk* tc);
+        void releaseTransactionChunk(TransactionChunk* tc);
         void deleteTransactionChunks(TransactionChunk* tc);
     };
 }
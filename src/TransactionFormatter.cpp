@@ -0,0 +1,108 @@
+/* Thread formatting committed transactions in parallel
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <new>
+#include <thread>
+
+#include "ConfigurationException.h"
+#include "OracleAnalyzer.h"
+#include "OutputBuffer.h"
+#include "RedoLogException.h"
+#include "RuntimeException.h"
+#include "Transaction.h"
+#include "TransactionFormatter.h"
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    TransactionFormatter::TransactionFormatter(const char *alias, OracleAnalyzer *oracleAnalyzer, uint64_t id, OutputBuffer *outputBuffer) :
+        Thread(alias),
+        oracleAnalyzer(oracleAnalyzer),
+        id(id),
+        outputBuffer(outputBuffer),
+        transaction(nullptr) {
+    }
+
+    TransactionFormatter::~TransactionFormatter() {
+        if (outputBuffer != nullptr) {
+            delete outputBuffer;
+            outputBuffer = nullptr;
+        }
+    }
+
+    void *TransactionFormatter::run(void) {
+        TRACE(TRACE2_THREADS, "FORMATTER (" << hex << this_thread::get_id() << ") START");
+
+        while (!shutdown) {
+            Transaction *formatted;
+            {
+                unique_lock<mutex> lck(oracleAnalyzer->formatterMtx);
+                while (transaction == nullptr && !shutdown)
+                    oracleAnalyzer->formatterCond.wait(lck);
+                formatted = transaction;
+            }
+
+            if (shutdown)
+                break;
+
+            bool ok = true;
+            try {
+                formatted->format(outputBuffer);
+            } catch(ConfigurationException &ex) {
+                ok = false;
+            } catch(RedoLogException &ex) {
+                ok = false;
+            } catch(RuntimeException &ex) {
+                ok = false;
+            } catch(bad_alloc &ex) {
+                ERROR("formatting of transaction " << PRINTXID(formatted->xid) << " failed: out of memory");
+                ok = false;
+            }
+
+            //wait for all transactions committed earlier
+            {
+                unique_lock<mutex> lck(oracleAnalyzer->formatterMtx);
+                while (oracleAnalyzer->formattersQueue.front() != this && !shutdown)
+                    oracleAnalyzer->formatterCond.wait(lck);
+            }
+
+            if (shutdown)
+                break;
+
+            if (ok)
+                oracleAnalyzer->outputBuffer->outputBufferSplice(outputBuffer);
+            else
+                outputBuffer->outputBufferReset();
+
+            {
+                unique_lock<mutex> lck(oracleAnalyzer->formatterMtx);
+                if (!ok)
+                    oracleAnalyzer->formatterFailed = true;
+                oracleAnalyzer->formattersQueue.pop_front();
+                oracleAnalyzer->formattedTransactions.push_back(formatted);
+                transaction = nullptr;
+                oracleAnalyzer->formatterCond.notify_all();
+            }
+        }
+
+        TRACE(TRACE2_THREADS, "FORMATTER (" << hex << this_thread::get_id() << ") STOP");
+        return 0;
+    }
+}
@@ -0,0 +1,52 @@
+/* Header for TransactionFormatter class
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include "Thread.h"
+
+#ifndef TRANSACTIONFORMATTER_H_
+#define TRANSACTIONFORMATTER_H_
+
+#define MAX_FORMATTER_THREADS   64
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    class OracleAnalyzer;
+    class OutputBuffer;
+    class Transaction;
+
+    //worker rendering a committed transaction into a private buffer, published to the output queue in commit order
+    class TransactionFormatter : public Thread {
+    protected:
+        OracleAnalyzer *oracleAnalyzer;
+        uint64_t id;
+
+        virtual void *run(void);
+
+    public:
+        OutputBuffer *outputBuffer;
+        Transaction *transaction;
+
+        TransactionFormatter(const char *alias, OracleAnalyzer *oracleAnalyzer, uint64_t id, OutputBuffer *outputBuffer);
+        virtual ~TransactionFormatter();
+    };
+}
+
+#endif
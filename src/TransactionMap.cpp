@@ -0,0 +1,94 @@
+/* Map of open transactions
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include "RuntimeException.h"
+#include "TransactionMap.h"
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    TransactionMap::TransactionMap() :
+        elements(0) {
+        memset(slots, 0, sizeof(slots));
+        memset(slotsSize, 0, sizeof(slotsSize));
+    }
+
+    TransactionMap::~TransactionMap() {
+        for (uint64_t usn = 0; usn < TRANSACTIONMAP_USN_MAX; ++usn) {
+            if (slots[usn] != nullptr) {
+                delete[] slots[usn];
+                slots[usn] = nullptr;
+            }
+        }
+    }
+
+    void TransactionMap::grow(uint64_t usn, uint64_t slt) {
+        uint64_t newSize = TRANSACTIONMAP_SLOTS_MIN;
+        while (newSize <= slt)
+            newSize *= 2;
+
+        Transaction **newSlots = new Transaction*[newSize];
+        if (newSlots == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << (newSize * sizeof(Transaction*)) << " bytes memory (for: transaction map)");
+        }
+        memset(newSlots, 0, newSize * sizeof(Transaction*));
+
+        if (slots[usn] != nullptr) {
+            memcpy(newSlots, slots[usn], slotsSize[usn] * sizeof(Transaction*));
+            delete[] slots[usn];
+        }
+        slots[usn] = newSlots;
+        slotsSize[usn] = newSize;
+    }
+
+    void TransactionMap::set(typeusnslt usnslt, Transaction *transaction) {
+        uint64_t usn = usnslt >> 16, slt = usnslt & 0xFFFF;
+        if (slt >= slotsSize[usn])
+            grow(usn, slt);
+
+        if (slots[usn][slt] != nullptr) {
+            RUNTIME_FAIL("transaction map slot " << dec << usn << "." << slt << " already in use");
+        }
+        slots[usn][slt] = transaction;
+        ++elements;
+    }
+
+    void TransactionMap::erase(typeusnslt usnslt) {
+        uint64_t usn = usnslt >> 16, slt = usnslt & 0xFFFF;
+        if (slt >= slotsSize[usn] || slots[usn][slt] == nullptr)
+            return;
+
+        slots[usn][slt] = nullptr;
+        --elements;
+    }
+
+    void TransactionMap::list(vector<Transaction*> &transactions) const {
+        for (uint64_t usn = 0; usn < TRANSACTIONMAP_USN_MAX; ++usn) {
+            for (uint64_t slt = 0; slt < slotsSize[usn]; ++slt) {
+                if (slots[usn][slt] != nullptr)
+                    transactions.push_back(slots[usn][slt]);
+            }
+        }
+    }
+
+    uint64_t TransactionMap::size(void) const {
+        return elements;
+    }
+}
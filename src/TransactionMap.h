@@ -0,0 +1,63 @@
+/* Header for TransactionMap class
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <vector>
+
+#include "types.h"
+
+#ifndef TRANSACTIONMAP_H_
+#define TRANSACTIONMAP_H_
+
+#define TRANSACTIONMAP_USN_MAX      65536
+#define TRANSACTIONMAP_SLOTS_MIN    256
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    class Transaction;
+
+    //open transactions indexed directly by undo segment number and slot
+    class TransactionMap {
+    protected:
+        Transaction **slots[TRANSACTIONMAP_USN_MAX];
+        uint32_t slotsSize[TRANSACTIONMAP_USN_MAX];
+        uint64_t elements;
+
+        void grow(uint64_t usn, uint64_t slt);
+
+    public:
+        TransactionMap();
+        virtual ~TransactionMap();
+
+        Transaction *find(typeusnslt usnslt) const {
+            uint64_t usn = usnslt >> 16, slt = usnslt & 0xFFFF;
+            if (slt >= slotsSize[usn])
+                return nullptr;
+            return slots[usn][slt];
+        }
+
+        void set(typeusnslt usnslt, Transaction *transaction);
+        void erase(typeusnslt usnslt);
+        void list(vector<Transaction*> &transactions) const;
+        uint64_t size(void) const;
+    };
+}
+
+#endif
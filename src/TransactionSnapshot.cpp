@@ -0,0 +1,269 @@
+/* Snapshot of open transactions
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "OracleAnalyzer.h"
+#include "OutputBuffer.h"
+#include "RuntimeException.h"
+#include "Transaction.h"
+#include "TransactionBuffer.h"
+#include "TransactionSnapshot.h"
+#include "Writer.h"
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    TransactionSnapshot::TransactionSnapshot(const char *alias, OracleAnalyzer *oracleAnalyzer, uint64_t interval) :
+        Thread(alias),
+        oracleAnalyzer(oracleAnalyzer),
+        interval(interval),
+        lastWrite(time(nullptr)),
+        pendingFile(nullptr),
+        pendingScn(0),
+        sequence(0),
+        block(0) {
+
+        //snapshots left by previous run
+        DIR *dir;
+        if ((dir = opendir(".")) == nullptr)
+            return;
+
+        string prefix = oracleAnalyzer->database + "-snapshot-";
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != nullptr) {
+            string name = ent->d_name;
+            if (name.length() <= prefix.length() + 4 || name.compare(0, prefix.length(), prefix) != 0 ||
+                    name.compare(name.length() - 4, 4, ".dat") != 0)
+                continue;
+
+            typescn scn = strtoull(name.c_str() + prefix.length(), nullptr, 10);
+            if (scn > 0)
+                snapshots.insert(scn);
+        }
+        closedir(dir);
+    }
+
+    TransactionSnapshot::~TransactionSnapshot() {
+        if (pendingFile != nullptr) {
+            delete pendingFile;
+            pendingFile = nullptr;
+        }
+    }
+
+    void TransactionSnapshot::doShutdown(void) {
+        unique_lock<mutex> lck(mtx);
+        shutdown = true;
+        cond.notify_all();
+    }
+
+    //file written by analyzer thread is closed and published here, while parsing continues
+    void *TransactionSnapshot::run(void) {
+        TRACE(TRACE2_THREADS, "SNAPSHOT (" << hex << this_thread::get_id() << ") START");
+
+        while (true) {
+            ofstream *outfile;
+            typescn scn;
+            {
+                unique_lock<mutex> lck(mtx);
+                while (pendingFile == nullptr && !shutdown)
+                    cond.wait(lck);
+                if (pendingFile == nullptr)
+                    break;
+                outfile = pendingFile;
+                scn = pendingScn;
+            }
+
+            finishFile(outfile, scn);
+
+            {
+                unique_lock<mutex> lck(mtx);
+                delete pendingFile;
+                pendingFile = nullptr;
+            }
+        }
+
+        TRACE(TRACE2_THREADS, "SNAPSHOT (" << hex << this_thread::get_id() << ") STOP");
+        return 0;
+    }
+
+    string TransactionSnapshot::fileName(typescn scn) {
+        return oracleAnalyzer->database + "-snapshot-" + to_string(scn) + ".dat";
+    }
+
+    void TransactionSnapshot::prune(typescn confirmedScn) {
+        //keep the newest snapshot which is already covered by the writer checkpoint and all later ones
+        auto it = snapshots.upper_bound(confirmedScn);
+        if (it == snapshots.begin())
+            return;
+        --it;
+
+        while (snapshots.begin() != it) {
+            string name = fileName(*snapshots.begin());
+            if (remove(name.c_str()) != 0) {
+                WARNING("can't remove snapshot file: " << name);
+            }
+            snapshots.erase(snapshots.begin());
+        }
+    }
+
+    void TransactionSnapshot::write(typeseq sequence, typeblk block, typescn scn) {
+        time_t now = time(nullptr);
+        if ((uint64_t)(now - lastWrite) < interval)
+            return;
+
+        {
+            unique_lock<mutex> lck(mtx);
+            //previous snapshot still being closed, try again at next LWN
+            if (pendingFile != nullptr || snapshots.count(scn) > 0)
+                return;
+        }
+        lastWrite = now;
+
+        vector<Transaction*> transactions;
+        oracleAnalyzer->xidTransactionMap.list(transactions);
+        FULL("snapshot - writing scn: " << dec << scn << " seq: " << sequence << " block: " << block << " transactions: " << transactions.size());
+
+        //transactions are serialized straight to the file, no copy of the whole snapshot is kept in memory
+        string nameTmp = fileName(scn) + ".tmp";
+        ofstream *outfile = new ofstream();
+        if (outfile == nullptr) {
+            RUNTIME_FAIL("couldn't allocate " << dec << sizeof(ofstream) << " bytes memory (for: snapshot file)");
+        }
+        outfile->open(nameTmp.c_str(), ios::out | ios::trunc | ios::binary);
+        if (!outfile->is_open()) {
+            WARNING("can't open snapshot file " << nameTmp << " for write, snapshot skipped");
+            delete outfile;
+            return;
+        }
+
+        uint64_t header[9];
+        header[0] = SNAPSHOT_MAGIC;
+        header[1] = SNAPSHOT_VERSION;
+        header[2] = oracleAnalyzer->resetlogs;
+        header[3] = oracleAnalyzer->activation;
+        header[4] = sequence;
+        header[5] = block;
+        header[6] = scn;
+        header[7] = transactions.size();
+        header[8] = oracleAnalyzer->database.length();
+        outfile->write((const char*)header, sizeof(header));
+        outfile->write(oracleAnalyzer->database.c_str(), oracleAnalyzer->database.length());
+
+        for (Transaction *transaction : transactions)
+            transaction->writeSnapshot(*outfile);
+
+        unique_lock<mutex> lck(mtx);
+        pendingFile = outfile;
+        pendingScn = scn;
+        cond.notify_all();
+    }
+
+    //failed snapshot is not fatal, restart uses an older one or the checkpoint
+    void TransactionSnapshot::finishFile(ofstream *outfile, typescn scn) {
+        string name = fileName(scn);
+        string nameTmp = name + ".tmp";
+        outfile->close();
+
+        if (outfile->fail()) {
+            WARNING("writing snapshot data to " << nameTmp << " failed, snapshot skipped");
+            remove(nameTmp.c_str());
+        } else if (rename(nameTmp.c_str(), name.c_str()) != 0) {
+            WARNING("renaming snapshot file " << nameTmp << " to " << name << " failed, snapshot skipped");
+            remove(nameTmp.c_str());
+        } else {
+            unique_lock<mutex> lck(mtx);
+            snapshots.insert(scn);
+            prune(oracleAnalyzer->outputBuffer->writer->getCheckpointScn());
+        }
+    }
+
+    //transactions committed after snapshot position and up to confirmed SCN are skipped during processing
+    bool TransactionSnapshot::read(typescn maxScn) {
+        vector<typescn> candidates;
+        {
+            unique_lock<mutex> lck(mtx);
+            for (auto it = snapshots.begin(); it != snapshots.end() && *it <= maxScn; ++it)
+                candidates.push_back(*it);
+        }
+
+        //damaged snapshot is skipped, the previous one is used
+        for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+            if (readFile(*it))
+                return true;
+        }
+
+        INFO("snapshot - no usable snapshot up to scn: " << dec << maxScn);
+        return false;
+    }
+
+    bool TransactionSnapshot::readFile(typescn scn) {
+        string name = fileName(scn);
+        ifstream infile;
+        infile.open(name.c_str(), ios::in | ios::binary);
+        if (!infile.is_open()) {
+            WARNING("can't open snapshot file: " << name);
+            return false;
+        }
+
+        uint64_t header[9];
+        infile.read((char*)header, sizeof(header));
+        if (infile.fail() || header[0] != SNAPSHOT_MAGIC || header[1] != SNAPSHOT_VERSION) {
+            WARNING("snapshot file: " << name << " has incompatible format, ignoring");
+            return false;
+        }
+        if (header[2] != oracleAnalyzer->resetlogs || header[3] != oracleAnalyzer->activation) {
+            WARNING("snapshot file: " << name << " is for other incarnation, ignoring");
+            return false;
+        }
+
+        string database(header[8], ' ');
+        infile.read(&database[0], header[8]);
+        if (infile.fail() || oracleAnalyzer->database.compare(database) != 0) {
+            WARNING("snapshot file: " << name << " has invalid database name, ignoring");
+            return false;
+        }
+
+        //transactions are published only when the whole file is read
+        vector<Transaction*> transactions;
+        for (uint64_t i = 0; i < header[7]; ++i) {
+            Transaction *transaction = Transaction::readSnapshot(oracleAnalyzer, infile);
+            if (transaction == nullptr) {
+                WARNING("snapshot file: " << name << " is truncated, ignoring");
+                for (Transaction *read : transactions)
+                    oracleAnalyzer->transactionBuffer->deleteTransaction(read);
+                return false;
+            }
+            transactions.push_back(transaction);
+        }
+        infile.close();
+
+        for (Transaction *transaction : transactions)
+            oracleAnalyzer->xidTransactionMap.set(transaction->xid >> 32, transaction);
+
+        sequence = header[4];
+        block = header[5];
+        INFO("snapshot - restored scn: " << dec << header[6] << " seq: " << sequence << " block: " << block << " transactions: " << header[7]);
+        return true;
+    }
+}
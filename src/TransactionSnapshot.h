@@ -0,0 +1,71 @@
+/* Header for TransactionSnapshot class
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "Thread.h"
+
+#ifndef TRANSACTIONSNAPSHOT_H_
+#define TRANSACTIONSNAPSHOT_H_
+
+#define SNAPSHOT_MAGIC              0x31504E534C524FULL
+#define SNAPSHOT_VERSION            2
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    class OracleAnalyzer;
+
+    //periodic snapshot of open transactions with redo position to resume from after restart
+    class TransactionSnapshot : public Thread {
+    protected:
+        OracleAnalyzer *oracleAnalyzer;
+        uint64_t interval;
+        time_t lastWrite;
+        set<typescn> snapshots;
+        mutex mtx;
+        condition_variable cond;
+        ofstream *pendingFile;
+        typescn pendingScn;
+
+        virtual void *run(void);
+        string fileName(typescn scn);
+        void prune(typescn confirmedScn);
+        void finishFile(ofstream *outfile, typescn scn);
+        bool readFile(typescn scn);
+
+    public:
+        typeseq sequence;
+        typeblk block;
+
+        TransactionSnapshot(const char *alias, OracleAnalyzer *oracleAnalyzer, uint64_t interval);
+        virtual ~TransactionSnapshot();
+
+        virtual void doShutdown(void);
+        void write(typeseq sequence, typeblk block, typescn scn);
+        bool read(typescn maxScn);
+    };
+}
+
+#endif
@@ -0,0 +1,165 @@
+/* Statistics of transactions
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <algorithm>
+
+#include "OracleAnalyzer.h"
+#include "Transaction.h"
+#include "TransactionBuffer.h"
+#include "TransactionStats.h"
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    TransactionStats::TransactionStats(OracleAnalyzer *oracleAnalyzer) :
+        oracleAnalyzer(oracleAnalyzer),
+        lastReport(time(nullptr)),
+        committed(0),
+        rolledBack(0),
+        partialRollbacks(0),
+        maxCommittedBytes(0),
+        maxCommittedOps(0),
+        interval(0),
+        top(10) {
+        memset(sizeHistogram, 0, sizeof(sizeHistogram));
+    }
+
+    TransactionStats::~TransactionStats() {
+    }
+
+    void TransactionStats::commit(Transaction *transaction) {
+        if (transaction->isRollback) {
+            ++rolledBack;
+            return;
+        }
+        ++committed;
+
+        //size is only needed for reports
+        if (interval == 0)
+            return;
+
+        uint64_t chunks, bytes, lwnBytes;
+        transaction->getSize(chunks, bytes, lwnBytes);
+        if (bytes > maxCommittedBytes)
+            maxCommittedBytes = bytes;
+        if (transaction->opCodes + transaction->streamedOps > maxCommittedOps)
+            maxCommittedOps = transaction->opCodes + transaction->streamedOps;
+
+        //buckets: <1KB, <4KB, <16KB, ... , <1GB, larger
+        uint64_t bucket = 0, limit = 1024;
+        while (bytes >= limit && bucket < TRANSACTION_STATS_BUCKETS - 1) {
+            limit <<= 2;
+            ++bucket;
+        }
+        ++sizeHistogram[bucket];
+    }
+
+    void TransactionStats::rollbackOp(void) {
+        ++partialRollbacks;
+    }
+
+    void TransactionStats::report(typetime time) {
+        lastTime = time;
+        if (interval == 0)
+            return;
+
+        time_t now = ::time(nullptr);
+        if ((uint64_t)(now - lastReport) < interval)
+            return;
+        lastReport = now;
+
+        INFO("transaction stats: " << *this);
+    }
+
+    ostream& operator<<(ostream& os, const TransactionStats& stats) {
+        OracleAnalyzer *oracleAnalyzer = stats.oracleAnalyzer;
+        vector<Transaction*> transactions;
+        oracleAnalyzer->xidTransactionMap.list(transactions);
+
+        //memory held: own transaction chunks and whole LWN chunks retained by the transaction
+        struct TransactionSize {
+            Transaction *transaction;
+            uint64_t chunks;
+            uint64_t bytes;
+            uint64_t lwnChunks;
+            uint64_t lwnBytes;
+            uint64_t memory;
+        };
+        vector<TransactionSize> sizes;
+        uint64_t totalBytes = 0;
+        for (Transaction *transaction : transactions) {
+            TransactionSize size;
+            size.transaction = transaction;
+            transaction->getSize(size.chunks, size.bytes, size.lwnBytes);
+            size.lwnChunks = transaction->lwnChunks.size();
+            size.memory = size.chunks * FULL_BUFFER_SIZE + size.lwnChunks * MEMORY_CHUNK_SIZE;
+            totalBytes += size.bytes;
+            sizes.push_back(size);
+        }
+
+        TransactionBuffer *transactionBuffer = oracleAnalyzer->transactionBuffer;
+        os << "open: " << dec << transactions.size() <<
+                " bytes: " << dec << totalBytes <<
+                " buffer: " << dec << (transactionBuffer->partiallyFullChunks.size() * MEMORY_CHUNK_SIZE_MB) << "MB" <<
+                " lwn retained: " << dec << transactionBuffer->lwnChunksRetained <<
+                " lwn pinned: " << dec << (transactionBuffer->lwnChunksPinned * MEMORY_CHUNK_SIZE_MB) << "MB" <<
+                " committed: " << dec << stats.committed <<
+                " rolled back: " << dec << stats.rolledBack <<
+                " partial rollbacks: " << dec << stats.partialRollbacks <<
+                " max bytes: " << dec << stats.maxCommittedBytes <<
+                " max ops: " << dec << stats.maxCommittedOps << endl;
+
+        os << "committed size histogram:";
+        uint64_t limit = 1;
+        for (uint64_t i = 0; i < TRANSACTION_STATS_BUCKETS; ++i) {
+            if (i < TRANSACTION_STATS_BUCKETS - 1)
+                os << " <" << dec << limit << "KB: " << stats.sizeHistogram[i];
+            else
+                os << " larger: " << dec << stats.sizeHistogram[i];
+            limit <<= 2;
+        }
+        os << endl;
+
+        uint64_t top = min(stats.top, (uint64_t)sizes.size());
+        partial_sort(sizes.begin(), sizes.begin() + top, sizes.end(),
+                [](const TransactionSize &a, const TransactionSize &b) { return a.memory > b.memory; });
+        for (uint64_t i = 0; i < top; ++i)
+            os << "top size #" << dec << (i + 1) << ": memory: " << sizes[i].memory << " bytes: " << sizes[i].bytes <<
+                    " chunks: " << sizes[i].chunks << " lwn chunks: " << sizes[i].lwnChunks << " lwn bytes: " << sizes[i].lwnBytes <<
+                    " " << *sizes[i].transaction << endl;
+
+        //transactions without begin record have unknown age
+        typetime lastTime = stats.lastTime;
+        time_t now = lastTime.toTime();
+        partial_sort(sizes.begin(), sizes.begin() + top, sizes.end(),
+                [](const TransactionSize &a, const TransactionSize &b) {
+                    if (a.transaction->firstScn == 0 || b.transaction->firstScn == 0)
+                        return b.transaction->firstScn == 0 && a.transaction->firstScn != 0;
+                    return a.transaction->firstScn < b.transaction->firstScn; });
+        for (uint64_t i = 0; i < top; ++i) {
+            if (sizes[i].transaction->firstScn == 0)
+                break;
+            os << "top age #" << dec << (i + 1) << ": seconds: " << (now - sizes[i].transaction->firstTime.toTime()) <<
+                    " first scn: " << sizes[i].transaction->firstScn << " " << *sizes[i].transaction << endl;
+        }
+
+        return os;
+    }
+}
@@ -0,0 +1,64 @@
+/* Header for TransactionStats class
+   Copyright (C) 2018-2020 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <ostream>
+
+#include "types.h"
+
+#ifndef TRANSACTIONSTATS_H_
+#define TRANSACTIONSTATS_H_
+
+#define TRANSACTION_STATS_BUCKETS   12
+
+using namespace std;
+
+namespace OpenLogReplicator {
+
+    class OracleAnalyzer;
+    class Transaction;
+
+    //counters of open and finished transactions, logged periodically
+    class TransactionStats {
+    protected:
+        OracleAnalyzer *oracleAnalyzer;
+        time_t lastReport;
+        typetime lastTime;
+        uint64_t committed;
+        uint64_t rolledBack;
+        uint64_t partialRollbacks;
+        uint64_t maxCommittedBytes;
+        uint64_t maxCommittedOps;
+        uint64_t sizeHistogram[TRANSACTION_STATS_BUCKETS];
+
+    public:
+        uint64_t interval;
+        uint64_t top;
+
+        TransactionStats(OracleAnalyzer *oracleAnalyzer);
+        virtual ~TransactionStats();
+
+        void commit(Transaction *transaction);
+        void rollbackOp(void);
+        void report(typetime time);
+
+        friend ostream& operator<<(ostream& os, const TransactionStats& stats);
+    };
+}
+
+#endif
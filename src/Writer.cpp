@@ -179,6 +179,11 @@ namespace OpenLogReplicator {
         }
     }
 
+    typescn Writer::getCheckpointScn(void) {
+        unique_lock<mutex> lck(mtx);
+        return checkpointScn;
+    }
+
     void *Writer::run(void) {
         TRACE(TRACE2_THREADS, "WRITER (" << hex << this_thread::get_id() << ") START");
 
@@ -349,7 +354,10 @@ namespace OpenLogReplicator {
         outfile << ss.rdbuf();
         outfile.close();
 
-        checkpointScn = confirmedScn;
+        {
+            unique_lock<mutex> lck(mtx);
+            checkpointScn = confirmedScn;
+        }
         previousCheckpoint = now;
     }
 
@@ -17,6 +17,8 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <mutex>
+
 #include "Thread.h"
 
 #ifndef WRITER_H_
@@ -33,6 +35,7 @@ namespace OpenLogReplicator {
 
     class Writer : public Thread {
     protected:
+        mutex mtx;                  //checkpointScn read by analyzer thread
         OutputBuffer *outputBuffer;
         uint64_t confirmedMessages;
         uint64_t sentMessages;
@@ -69,6 +72,7 @@ namespace OpenLogReplicator {
                 int64_t startTimeRel);
         virtual ~Writer();
         void confirmMessage(OutputBufferMsg *msg);
+        typescn getCheckpointScn(void);
     };
 }
 
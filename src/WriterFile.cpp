@@ -57,7 +57,7 @@ namespace OpenLogReplicator {
     }
 
     void WriterFile::sendMessage(OutputBufferMsg *msg) {
-        output->write((const char*)msg->data, msg->length);
+        output->write((const char*)msg->data + msg->keyLength, msg->length - msg->keyLength);
         if (((ofstream*)output)->fail()) {
             RUNTIME_FAIL("error writing to write: " << dec << name);
         }
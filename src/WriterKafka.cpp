@@ -20,7 +20,9 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "OutputBuffer.h"
 #include "ConfigurationException.h"
 #include "OracleAnalyzer.h"
+#include "OracleObject.h"
 #include "RuntimeException.h"
+#include "Schema.h"
 #include "WriterKafka.h"
 
 using namespace std;
@@ -31,7 +33,8 @@ namespace OpenLogReplicator {
 
     WriterKafka::WriterKafka(const char *alias, OracleAnalyzer *oracleAnalyzer, const char *brokers, const char *topic,
             uint64_t maxMessageMb, uint64_t maxMessages, uint64_t pollInterval, uint64_t checkpointInterval, uint64_t queueSize,
-            typescn startScn, typeseq startSeq, const char* startTime, uint64_t startTimeRel, uint64_t enableIdempotence) :
+            typescn startScn, typeseq startSeq, const char* startTime, uint64_t startTimeRel, uint64_t enableIdempotence,
+            map<string, string> &properties, uint64_t benchmark) :
         Writer(alias, oracleAnalyzer, maxMessageMb, pollInterval, checkpointInterval, queueSize, startScn, startSeq, startTime,
                 startTimeRel),
         brokers(brokers),
@@ -40,7 +43,12 @@ namespace OpenLogReplicator {
         enableIdempotence(enableIdempotence),
         rk(nullptr),
         rkt(nullptr),
-        conf(nullptr) {
+        conf(nullptr),
+        benchmark(benchmark),
+        deliveredMessages(0),
+        deliveredBytes(0),
+        reportedMessages(0),
+        reportedBytes(0) {
 
         conf = rd_kafka_conf_new();
         if (conf == nullptr) {
@@ -58,6 +66,18 @@ namespace OpenLogReplicator {
             CONFIG_FAIL("Kafka message: " << errstr);
         }
 
+        //producer properties passed as is, may override the defaults above
+        for (auto it : properties) {
+            if (rd_kafka_conf_set(conf, it.first.c_str(), it.second.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+                CONFIG_FAIL("Kafka property: " << it.first << ", message: " << errstr);
+            }
+            if (isSecret(it.first)) {
+                INFO("Kafka property: " << it.first << "=***");
+            } else {
+                INFO("Kafka property: " << it.first << "=" << it.second);
+            }
+        }
+
         rd_kafka_conf_set_dr_msg_cb(conf, dr_msg_cb);
         rd_kafka_conf_set_error_cb(conf, error_cb);
         rd_kafka_conf_set_log_cb(conf, logger_cb);
@@ -70,12 +90,22 @@ namespace OpenLogReplicator {
         conf = nullptr;
 
         rkt = rd_kafka_topic_new(rk, topic, nullptr);
+        benchmarkStart = chrono::steady_clock::now();
+        benchmarkReport = benchmarkStart;
     }
 
     WriterKafka::~WriterKafka() {
+        if (benchmark > 0)
+            benchmarkStats(true);
+
         if (conf != nullptr)
             rd_kafka_conf_destroy(conf);
 
+        for (auto it : topicHandles)
+            rd_kafka_topic_destroy(it.second);
+        topicHandles.clear();
+        tableTopics.clear();
+
         if (rkt != nullptr)
             rd_kafka_topic_destroy(rkt);
 
@@ -92,7 +122,10 @@ namespace OpenLogReplicator {
         if (rkmessage->err) {
             WARNING("Kafka: " << msg->id << " delivery failed: " << rd_kafka_err2str(rkmessage->err));
         } else {
-            oracleAnalyzer->outputBuffer->writer->confirmMessage(msg);
+            WriterKafka *writer = (WriterKafka*)oracleAnalyzer->outputBuffer->writer;
+            ++writer->deliveredMessages;
+            writer->deliveredBytes += rkmessage->len + rkmessage->key_len;
+            writer->confirmMessage(msg);
         }
     }
 
@@ -113,14 +146,93 @@ namespace OpenLogReplicator {
         TRACE_(TRACE2_KAFKA, "level: " << dec << level << ", rk: " << (rk ? rd_kafka_name(rk) : NULL) << ", fac: " << fac << ", err: " << buf);
     }
 
+    //tables matching a topic mask (LIKE syntax: % and _) go to their own topic, everything else to the default topic
+    void WriterKafka::addTopic(const char *mask, const char *topic) {
+        topicMasks.push_back(mask);
+        topicNames.push_back(topic);
+    }
+
+    bool WriterKafka::matchMask(const char *mask, const char *name) {
+        while (*mask != 0) {
+            if (*mask == '%') {
+                ++mask;
+                if (*mask == 0)
+                    return true;
+                for (; *name != 0; ++name)
+                    if (matchMask(mask, name))
+                        return true;
+                return false;
+            }
+            if (*name == 0 || (*mask != '_' && *mask != *name))
+                return false;
+            ++mask;
+            ++name;
+        }
+        return *name == 0;
+    }
+
+    //credentials and key material must not end up in the log
+    bool WriterKafka::isSecret(const string &name) {
+        string lower(name);
+        for (char &c : lower)
+            c = tolower(c);
+        return lower.find("password") != string::npos ||
+                lower.find("secret") != string::npos ||
+                lower.find("key") != string::npos ||
+                lower.find("oauthbearer") != string::npos ||
+                lower.find("jaas") != string::npos;
+    }
+
+    rd_kafka_topic_t *WriterKafka::getTopic(OutputBufferMsg *msg) {
+        if (topicMasks.size() == 0 || msg->dictId == 0)
+            return rkt;
+
+        auto it = tableTopics.find(msg->dictId);
+        if (it != tableTopics.end())
+            return it->second;
+
+        rd_kafka_topic_t *rktTable = rkt;
+        OracleObject *object = oracleAnalyzer->schema->checkDict(msg->dictId, 0);
+        if (object != nullptr) {
+            string name = object->owner + "." + object->name;
+            for (uint64_t i = 0; i < topicMasks.size(); ++i) {
+                if (!matchMask(topicMasks[i].c_str(), name.c_str()))
+                    continue;
+
+                auto itHandle = topicHandles.find(topicNames[i]);
+                if (itHandle != topicHandles.end()) {
+                    rktTable = itHandle->second;
+                } else {
+                    rktTable = rd_kafka_topic_new(rk, topicNames[i].c_str(), nullptr);
+                    if (rktTable == nullptr) {
+                        RUNTIME_FAIL("Kafka failed to create topic: " << topicNames[i] << ", message: " << rd_kafka_err2str(rd_kafka_last_error()));
+                    }
+                    topicHandles[topicNames[i]] = rktTable;
+                }
+                INFO("Kafka: table " << name << " sent to topic: " << topicNames[i]);
+                break;
+            }
+        }
+
+        tableTopics[msg->dictId] = rktTable;
+        return rktTable;
+    }
+
     void WriterKafka::sendMessage(OutputBufferMsg *msg) {
+        rd_kafka_topic_t *rktMsg = getTopic(msg);
+
         for(;;) {
-            rd_kafka_resp_err_t err = rd_kafka_producev(rk, RD_KAFKA_V_TOPIC(topic.c_str()), RD_KAFKA_V_VALUE(msg->data, msg->length),
-                    RD_KAFKA_V_OPAQUE(msg), RD_KAFKA_V_END);
-            //rd_kafka_resp_err_t err = (rd_kafka_resp_err_t)rd_kafka_produce(rkt, RD_KAFKA_PARTITION_UA, 0, msg->data, msg->length, nullptr, 0, msg);
+            //row messages carry the key in front of the data, Kafka keeps messages with the same key in one partition
+            rd_kafka_resp_err_t err;
+            if (msg->keyLength > 0)
+                err = rd_kafka_producev(rk, RD_KAFKA_V_RKT(rktMsg), RD_KAFKA_V_KEY(msg->data, msg->keyLength),
+                        RD_KAFKA_V_VALUE((msg->data + msg->keyLength), msg->length - msg->keyLength), RD_KAFKA_V_OPAQUE(msg), RD_KAFKA_V_END);
+            else
+                err = rd_kafka_producev(rk, RD_KAFKA_V_RKT(rktMsg), RD_KAFKA_V_VALUE(msg->data, msg->length),
+                        RD_KAFKA_V_OPAQUE(msg), RD_KAFKA_V_END);
 
             if (err) {
-                WARNING("Failed to produce to topic " << topic.c_str() << ", message: " << rd_kafka_err2str(err));
+                WARNING("Failed to produce to topic " << rd_kafka_topic_name(rktMsg) << ", message: " << rd_kafka_err2str(err));
 
                 if (err == RD_KAFKA_RESP_ERR__QUEUE_FULL) {
                     WARNING("Queue, full, sleeping " << (pollInterval / 1000) << "ms, then retrying");
@@ -144,5 +256,32 @@ namespace OpenLogReplicator {
     void WriterKafka::pollQueue(void) {
         if (curQueueSize > 0)
             rd_kafka_poll(rk, 0);
+
+        if (benchmark > 0 && chrono::steady_clock::now() - benchmarkReport >= chrono::seconds(benchmark))
+            benchmarkStats(false);
+    }
+
+    //throughput of delivered messages (key and value) since last report, or since start for the total
+    void WriterKafka::benchmarkStats(bool total) {
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        uint64_t messages = deliveredMessages, bytes = deliveredBytes;
+        double seconds;
+
+        if (total) {
+            seconds = chrono::duration<double>(now - benchmarkStart).count();
+        } else {
+            seconds = chrono::duration<double>(now - benchmarkReport).count();
+            messages -= reportedMessages;
+            bytes -= reportedBytes;
+            reportedMessages = deliveredMessages;
+            reportedBytes = deliveredBytes;
+            benchmarkReport = now;
+        }
+        if (seconds <= 0)
+            return;
+
+        INFO("Kafka " << (total ? "total" : "benchmark") << ": " << dec << messages << " messages, " << bytes << " bytes in " <<
+                fixed << setprecision(1) << seconds << "s, " << (messages / seconds) << " messages/s, " <<
+                setprecision(2) << (bytes / seconds / 1024 / 1024) << " MB/s");
     }
 }
@@ -17,7 +17,11 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <chrono>
 #include <librdkafka/rdkafka.h>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "Writer.h"
 
@@ -44,10 +48,25 @@ namespace OpenLogReplicator {
         rd_kafka_t *rk;
         rd_kafka_topic_t *rkt;
         rd_kafka_conf_t *conf;
+        vector<string> topicMasks;
+        vector<string> topicNames;
+        unordered_map<string, rd_kafka_topic_t*> topicHandles;
+        unordered_map<typeobj, rd_kafka_topic_t*> tableTopics;  //topic of every table, resolved on first message
+        uint64_t benchmark;                                     //seconds between throughput reports, 0 - disabled
+        uint64_t deliveredMessages;
+        uint64_t deliveredBytes;
+        uint64_t reportedMessages;
+        uint64_t reportedBytes;
+        chrono::steady_clock::time_point benchmarkStart;
+        chrono::steady_clock::time_point benchmarkReport;
         static void dr_msg_cb(rd_kafka_t *rk, const rd_kafka_message_t *rkmessage, void *opaque);
         static void error_cb(rd_kafka_t *rk, int err, const char *reason, void *opaque);
         static void logger_cb(const rd_kafka_t *rk, int level, const char *fac, const char *buf);
 
+        rd_kafka_topic_t *getTopic(OutputBufferMsg *msg);
+        static bool matchMask(const char *mask, const char *name);
+        static bool isSecret(const string &name);
+        void benchmarkStats(bool total);
         virtual void sendMessage(OutputBufferMsg *msg);
         virtual string getName();
         virtual void pollQueue(void);
@@ -55,8 +74,11 @@ namespace OpenLogReplicator {
     public:
         WriterKafka(const char *alias, OracleAnalyzer *oracleAnalyzer, const char *brokers, const char *topic, uint64_t maxMessageMb,
                 uint64_t maxMessages, uint64_t pollInterval, uint64_t checkpointInterval, uint64_t queueSize, typescn startScn,
-                typeseq startSeq, const char* startTime, uint64_t startTimeRel, uint64_t enableIdempotence);
+                typeseq startSeq, const char* startTime, uint64_t startTimeRel, uint64_t enableIdempotence,
+                map<string, string> &properties, uint64_t benchmark);
         virtual ~WriterKafka();
+
+        void addTopic(const char *mask, const char *topic);
     };
 }
 
@@ -221,6 +221,6 @@ namespace OpenLogReplicator {
     }
 
     void WriterStream::sendMessage(OutputBufferMsg *msg) {
-        stream->sendMessage(msg->data, msg->length);
+        stream->sendMessage(msg->data + msg->keyLength, msg->length - msg->keyLength);
     }
 }
@@ -151,6 +151,7 @@ typedef uint64_t typeunicode;
 #define OUTPUT_BUFFER_DATA_SIZE                 (MEMORY_CHUNK_SIZE - sizeof(struct OutputBufferQueue))
 #define OUTPUT_BUFFER_ALLOCATED                 0x0001
 #define OUTPUT_BUFFER_CONFIRMED                 0x0002
+#define OUTPUT_BUFFER_RESERVE_SIZE              8192
 
 #define VALUE_BEFORE                            0
 #define VALUE_AFTER                             1